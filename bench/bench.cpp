@@ -0,0 +1,456 @@
+// C++ Memory Visualizer - 핵심 경로 마이크로벤치마크
+//
+// 블록 수 10부터 10M까지 10배씩 늘려 가며 각 연산의 ns/op와 allocs/op(전역 operator new 호출 수)를
+// 재고, 저장해 둔 기준값(bench/baseline.txt)과 비교해 느려진 항목을 표시함
+//
+// 사용법: memviz_bench [--filter 이름] [--min-blocks N] [--max-blocks N] [--min-time ms] [--repeat N]
+//                      [--baseline 파일] [--save-baseline 파일] [--threshold 퍼센트]
+
+#define MEMVIZ_NO_MAIN
+#include "main.cpp"
+
+#include <new>
+#include <iomanip>
+
+#ifndef MEMVIZ_BENCH_BASELINE
+#define MEMVIZ_BENCH_BASELINE "bench/baseline.txt"
+#endif
+
+// ==================== 할당 횟수 계측 ====================
+
+// 전역 operator new를 바꿔 힙 할당 횟수를 셈 (배열/nothrow 버전은 기본 구현이 이쪽을 부름)
+static atomic<uint64_t> allocationCount{ 0 };
+
+void* operator new(size_t size) {
+    allocationCount.fetch_add(1, memory_order_relaxed);
+    if (void* p = malloc(size ? size : 1)) return p;
+    throw bad_alloc();
+}
+
+void operator delete(void* p) noexcept { free(p); }
+void operator delete(void* p, size_t) noexcept { free(p); }
+
+// ==================== 측정 ====================
+
+struct BenchResult {
+    string name;
+    uint64_t blocks;
+    double nsPerOp;
+    double allocsPerOp;
+};
+
+struct BenchOptions {
+    string filter;
+    uint64_t minBlocks = 10;
+    uint64_t maxBlocks = 10000000;
+    double minTimeMs = 100;
+    int repeat = 3;
+    string baselinePath = MEMVIZ_BENCH_BASELINE;
+    string savePath;
+    double thresholdPercent = 150;
+};
+
+// setup(준비, 시간에서 제외) 후 body(연산 수 반환)를 한 번 실행한 결과
+struct Sample {
+    uint64_t ops;
+    uint64_t allocations;
+    double elapsedNs;
+};
+
+template <typename Setup, typename Body>
+Sample runOnce(Setup& setup, Body& body) {
+    using Clock = chrono::steady_clock;
+    setup();
+    uint64_t allocationsBefore = allocationCount.load(memory_order_relaxed);
+    auto start = Clock::now();
+    uint64_t ops = body();
+    double elapsedNs = chrono::duration<double, nano>(Clock::now() - start).count();
+    return { ops, allocationCount.load(memory_order_relaxed) - allocationsBefore, elapsedNs };
+}
+
+// 첫 실행은 캐시와 버퍼 용량을 데우는 데 쓰고 (그것만으로 minTimeMs를 넘는 큰 측정은 그 결과를 씀),
+// 나머지 시간은 몇 라운드로 나눠 라운드별 ns/op의 중앙값을 씀 (한두 라운드의 간섭에 흔들리지 않음)
+template <typename Setup, typename Body>
+BenchResult measure(const string& name, uint64_t blocks, double minTimeMs, Setup&& setup, Body&& body) {
+    constexpr int ROUNDS = 7;
+    double minTimeNs = minTimeMs * 1e6;
+
+    Sample first = runOnce(setup, body);
+    if (first.elapsedNs >= minTimeNs) {
+        return { name, blocks, first.elapsedNs / (double)first.ops, (double)first.allocations / (double)first.ops };
+    }
+
+    double roundNs[ROUNDS];
+    uint64_t ops = 0;
+    uint64_t allocations = 0;
+    for (int round = 0; round < ROUNDS; round++) {
+        Sample total{ 0, 0, 0 };
+        do {
+            Sample sample = runOnce(setup, body);
+            total.ops += sample.ops;
+            total.allocations += sample.allocations;
+            total.elapsedNs += sample.elapsedNs;
+        } while (total.elapsedNs < minTimeNs / ROUNDS);
+        roundNs[round] = total.elapsedNs / (double)total.ops;
+        ops += total.ops;
+        allocations += total.allocations;
+    }
+    nth_element(roundNs, roundNs + ROUNDS / 2, roundNs + ROUNDS);
+    return { name, blocks, roundNs[ROUNDS / 2], (double)allocations / (double)ops };
+}
+
+// 결과가 최적화로 사라지지 않게 값을 흘려보냄
+static volatile uint64_t benchSink;
+
+// ==================== 벤치마크 ====================
+
+// n개의 힙 블록과 그중 짝수 번째를 가리키는 n/2개의 포인터 (나머지 절반은 누수)
+void populate(MemoryManager& memManager, uint64_t n, vector<int>& heapIds) {
+    memManager.reset();
+    heapIds.clear();
+    for (uint64_t i = 0; i < n; i++) {
+        heapIds.push_back(memManager.allocateHeap("block", 16));
+    }
+    for (uint64_t i = 0; i < n; i += 2) {
+        int ptr = memManager.createStackVariable("ptr", sizeof(void*), true);
+        memManager.assignPointer(ptr, heapIds[i]);
+    }
+}
+
+// 스크립트 실행 벤치마크용: n번 반복하며 힙 블록을 하나씩 새로 가리키는 스크립트
+string loopScript(uint64_t n) {
+    return "int main() {\n"
+        "    int* p;\n"
+        "    for (int i = 0; i < " + to_string(n) + "; i++) {\n"
+        "        p = new int;\n"
+        "    }\n"
+        "    return 0;\n"
+        "}\n";
+}
+
+// 벤치마크 하나: 이름, 돌릴 최대 블록 수, 블록 수 n에서 한 번 재는 함수
+// (함수마다 MemoryManager를 새로 만들어 앞선 벤치마크가 키워 둔 용량이 allocs/op에 섞이지 않게 함)
+struct Benchmark {
+    const char* name;
+    uint64_t maxBlocks;
+    function<BenchResult(uint64_t, double)> run;
+};
+
+vector<Benchmark> makeBenchmarks() {
+    vector<Benchmark> benchmarks;
+
+    benchmarks.push_back({ "allocateHeap", UINT64_MAX, [](uint64_t n, double minTime) {
+        MemoryManager memManager;
+        return measure("allocateHeap", n, minTime,
+            [&] { memManager.reset(); },
+            [&] {
+                for (uint64_t i = 0; i < n; i++) memManager.allocateHeap("block", 16);
+                return n;
+            });
+    } });
+
+    benchmarks.push_back({ "deallocate", UINT64_MAX, [](uint64_t n, double minTime) {
+        MemoryManager memManager;
+        vector<int> ids;
+        return measure("deallocate", n, minTime,
+            [&] {
+                memManager.reset();
+                ids.clear();
+                for (uint64_t i = 0; i < n; i++) ids.push_back(memManager.allocateHeap("block", 16));
+            },
+            [&] {
+                for (int id : ids) memManager.deallocate(id);
+                return n;
+            });
+    } });
+
+    benchmarks.push_back({ "assignPointer", UINT64_MAX, [](uint64_t n, double minTime) {
+        MemoryManager memManager;
+        vector<int> ids;
+        vector<int> pointers;
+        return measure("assignPointer", n, minTime,
+            [&] {
+                memManager.reset();
+                ids.clear();
+                pointers.clear();
+                for (uint64_t i = 0; i < n; i++) ids.push_back(memManager.allocateHeap("block", 16));
+                for (uint64_t i = 0; i < n; i++) pointers.push_back(memManager.createStackVariable("ptr", sizeof(void*), true));
+            },
+            [&] {
+                // 대상을 흩어 놓아 역참조 리스트가 여러 블록에 걸치게 함
+                for (uint64_t i = 0; i < n; i++) {
+                    memManager.assignPointer(pointers[i], ids[(i * 7919) % n]);
+                }
+                return n;
+            });
+    } });
+
+    benchmarks.push_back({ "findBlock", UINT64_MAX, [](uint64_t n, double minTime) {
+        MemoryManager memManager;
+        vector<int> ids;
+        bool ready = false;
+        return measure("findBlock", n, minTime,
+            [&] {
+                if (!ready) populate(memManager, n, ids);
+                ready = true;
+            },
+            [&] {
+                uint64_t lookups = max<uint64_t>(n, 4096);
+                uint64_t total = 0;
+                for (uint64_t i = 0; i < lookups; i++) {
+                    MemoryBlock block = memManager.findBlock(ids[(i * 2654435761u) % n]);
+                    total += block.size();
+                }
+                benchSink = total;
+                return lookups;
+            });
+    } });
+
+    benchmarks.push_back({ "detectLeaks", UINT64_MAX, [](uint64_t n, double minTime) {
+        MemoryManager memManager;
+        vector<int> ids;
+        bool ready = false;
+        return measure("detectLeaks", n, minTime,
+            [&] {
+                if (!ready) populate(memManager, n, ids);
+                ready = true;
+            },
+            [&] {
+                benchSink = memManager.detectLeaks().size();
+                return (uint64_t)1;
+            });
+    } });
+
+    // 도달성 분석: 상태가 바뀌어야 다시 계산하므로 매번 포인터 하나를 옮긴 뒤 감지
+    benchmarks.push_back({ "detectLeaks/reachability", UINT64_MAX, [](uint64_t n, double minTime) {
+        MemoryManager memManager;
+        vector<int> ids;
+        bool ready = false;
+        int pointer = -1;
+        uint64_t round = 0;
+        return measure("detectLeaks/reachability", n, minTime,
+            [&] {
+                if (!ready) {
+                    populate(memManager, n, ids);
+                    memManager.setLeakMode(LeakMode::REACHABILITY);
+                    pointer = memManager.createStackVariable("moving", sizeof(void*), true);
+                }
+                ready = true;
+            },
+            [&] {
+                memManager.assignPointer(pointer, ids[round++ % n]);
+                benchSink = memManager.detectLeaks().size();
+                return (uint64_t)1;
+            });
+    } });
+
+    benchmarks.push_back({ "executeScriptStepByStep", UINT64_MAX, [](uint64_t n, double minTime) {
+        MemoryManager memManager;
+        ScriptParser parser(memManager);
+        string script = loopScript(n);
+        return measure("executeScriptStepByStep", n, minTime,
+            [&] {
+                parser.reset();
+                memManager.reset();
+            },
+            [&] {
+                parser.executeScriptStepByStep(script, nullptr);
+                return n;
+            });
+    } });
+
+    // 한 프레임이 블록 수에 비례해 커지고 줄마다 문자열을 만들므로 1M 블록까지만 잼
+    benchmarks.push_back({ "renderFrame", 1000000, [](uint64_t n, double minTime) {
+        MemoryManager memManager;
+        vector<int> ids;
+        bool ready = false;
+        ostringstream out;
+        Visualizer visualizer(out);
+        return measure("renderFrame", n, minTime,
+            [&] {
+                if (!ready) {
+                    // 렌더러는 이전/현재 줄 버퍼를 번갈아 쓰므로 두 프레임을 미리 그려 둘 다 채움
+                    // (그래야 데우기 실행만으로 끝나는 큰 측정도 다른 측정과 같은 상태에서 재짐)
+                    populate(memManager, n, ids);
+                    for (int i = 0; i < 2; i++) visualizer.printMemoryStateWithLine(memManager, "p = new int;", 1);
+                }
+                ready = true;
+                out.str(string());
+            },
+            [&] {
+                visualizer.printMemoryStateWithLine(memManager, "p = new int;", 1);
+                benchSink = (uint64_t)out.tellp();
+                return (uint64_t)1;
+            });
+    } });
+
+    return benchmarks;
+}
+
+// ==================== 기준값 ====================
+
+// 기준값 파일: 한 줄에 "이름 블록수 ns/op allocs/op" ('#'으로 시작하면 주석)
+bool loadBaseline(const string& path, vector<BenchResult>& out) {
+    ifstream file(path);
+    if (!file) return false;
+    string line;
+    while (getline(file, line)) {
+        if (line.empty() || line[0] == '#') continue;
+        istringstream fields(line);
+        BenchResult entry;
+        if (fields >> entry.name >> entry.blocks >> entry.nsPerOp >> entry.allocsPerOp) {
+            out.push_back(entry);
+        }
+    }
+    return true;
+}
+
+bool saveBaseline(const string& path, const vector<BenchResult>& results) {
+    ofstream file(path);
+    if (!file) return false;
+    file << "# memviz_bench 기준값: 이름 블록수 ns/op allocs/op\n";
+    for (const auto& result : results) {
+        file << result.name << ' ' << result.blocks << ' '
+            << fixed << setprecision(2) << result.nsPerOp << ' '
+            << setprecision(3) << result.allocsPerOp << '\n';
+    }
+    return (bool)file;
+}
+
+// 할당 횟수는 시간보다 흔들림이 적으므로 조금만 늘어도 회귀로 봄
+bool hasMoreAllocations(const BenchResult& result, const BenchResult& base) {
+    return result.allocsPerOp > base.allocsPerOp * 1.05 + 0.01;
+}
+
+bool isRegression(const BenchResult& result, const BenchResult& base, const BenchOptions& options) {
+    double change = (result.nsPerOp / base.nsPerOp - 1) * 100;
+    return change > options.thresholdPercent || hasMoreAllocations(result, base);
+}
+
+const BenchResult* findBaseline(const vector<BenchResult>& baseline, const BenchResult& result) {
+    for (const auto& entry : baseline) {
+        if (entry.name == result.name && entry.blocks == result.blocks) return &entry;
+    }
+    return nullptr;
+}
+
+// ==================== 메인 ====================
+
+bool parseOptions(int argc, char* argv[], BenchOptions& options) {
+    for (int i = 1; i < argc; i++) {
+        string arg = argv[i];
+        bool hasValue = i + 1 < argc;
+        if (arg == "--filter" && hasValue) options.filter = argv[++i];
+        else if (arg == "--min-blocks" && hasValue) options.minBlocks = strtoull(argv[++i], nullptr, 10);
+        else if (arg == "--max-blocks" && hasValue) options.maxBlocks = strtoull(argv[++i], nullptr, 10);
+        else if (arg == "--min-time" && hasValue) options.minTimeMs = atof(argv[++i]);
+        else if (arg == "--repeat" && hasValue) options.repeat = atoi(argv[++i]);
+        else if (arg == "--baseline" && hasValue) options.baselinePath = argv[++i];
+        else if (arg == "--save-baseline" && hasValue) options.savePath = argv[++i];
+        else if (arg == "--threshold" && hasValue) options.thresholdPercent = atof(argv[++i]);
+        else return false;
+    }
+    return options.minBlocks > 0 && options.repeat > 0;
+}
+
+// 회귀로 보인 측정을 다시 재는 최대 횟수
+constexpr int REGRESSION_RETRIES = 3;
+
+// 같은 측정을 repeat번 (매번 새 상태로) 되풀이해 ns/op와 allocs/op 각각의 중앙값을 씀
+// (라운드 중앙값으로 못 거르는, 한 측정 내내 이어진 간섭을 거름)
+BenchResult runRepeated(const Benchmark& benchmark, uint64_t n, const BenchOptions& options) {
+    vector<BenchResult> runs;
+    for (int i = 0; i < options.repeat; i++) runs.push_back(benchmark.run(n, options.minTimeMs));
+
+    vector<double> ns, allocs;
+    for (const auto& run : runs) {
+        ns.push_back(run.nsPerOp);
+        allocs.push_back(run.allocsPerOp);
+    }
+    size_t middle = runs.size() / 2;
+    nth_element(ns.begin(), ns.begin() + middle, ns.end());
+    nth_element(allocs.begin(), allocs.begin() + middle, allocs.end());
+
+    BenchResult result = runs[0];
+    result.nsPerOp = ns[middle];
+    result.allocsPerOp = allocs[middle];
+    return result;
+}
+
+int main(int argc, char* argv[]) {
+    BenchOptions options;
+    if (!parseOptions(argc, argv, options)) {
+        cerr << "사용법: " << argv[0] << " [--filter 이름] [--min-blocks N] [--max-blocks N] [--min-time ms] [--repeat N]\n"
+            << "        [--baseline 파일] [--save-baseline 파일] [--threshold 퍼센트]\n"
+            << "  --filter         이름에 이 문자열이 들어간 벤치마크만 실행\n"
+            << "  --min-blocks     시작 블록 수 (기본 10, 10배씩 늘림)\n"
+            << "  --max-blocks     최대 블록 수 (기본 10000000)\n"
+            << "  --min-time       측정마다 최소 실행 시간 (기본 100ms)\n"
+            << "  --repeat         측정을 되풀이해 중앙값을 쓸 횟수 (기본 3)\n"
+            << "  --baseline       비교할 기준값 파일 (기본 " << MEMVIZ_BENCH_BASELINE << ")\n"
+            << "  --save-baseline  이번 결과를 기준값 파일로 저장\n"
+            << "  --threshold      ns/op가 기준값보다 이 비율 넘게 늘면 회귀로 표시 (기본 150)\n";
+        return 2;
+    }
+
+    vector<BenchResult> baseline;
+    bool compare = options.savePath.empty() && loadBaseline(options.baselinePath, baseline);
+
+    vector<Benchmark> benchmarks = makeBenchmarks();
+
+    cout << left << setw(26) << "benchmark" << right << setw(10) << "blocks"
+        << setw(16) << "ns/op" << setw(12) << "allocs/op";
+    if (compare) cout << setw(16) << "baseline" << setw(10) << "change";
+    cout << '\n';
+
+    vector<BenchResult> results;
+    int regressions = 0;
+    for (const auto& benchmark : benchmarks) {
+        if (!options.filter.empty() && string(benchmark.name).find(options.filter) == string::npos) continue;
+
+        for (uint64_t n = options.minBlocks; n <= min(options.maxBlocks, benchmark.maxBlocks); n *= 10) {
+            BenchResult result = runRepeated(benchmark, n, options);
+            const BenchResult* base = compare ? findBaseline(baseline, result) : nullptr;
+
+            // 회귀로 보이면 몇 번 더 재서 가장 좋은 값으로 판단
+            // (다른 프로세스의 간섭은 느리게만 만들고 몇 초씩 이어지기도 하므로, 진짜 회귀만 매번 느림)
+            for (int retry = 0; base && retry < REGRESSION_RETRIES && isRegression(result, *base, options); retry++) {
+                BenchResult again = runRepeated(benchmark, n, options);
+                result.nsPerOp = min(result.nsPerOp, again.nsPerOp);
+                result.allocsPerOp = min(result.allocsPerOp, again.allocsPerOp);
+            }
+            results.push_back(result);
+
+            cout << left << setw(26) << result.name << right << setw(10) << result.blocks
+                << fixed << setprecision(1) << setw(16) << result.nsPerOp
+                << setprecision(2) << setw(12) << result.allocsPerOp;
+
+            if (base) {
+                double change = (result.nsPerOp / base->nsPerOp - 1) * 100;
+                cout << setprecision(1) << setw(16) << base->nsPerOp
+                    << setw(9) << showpos << change << noshowpos << '%';
+                if (isRegression(result, *base, options)) {
+                    cout << "  회귀" << (hasMoreAllocations(result, *base) ? " (할당 증가)" : "");
+                    regressions++;
+                }
+            }
+            cout << endl;
+        }
+    }
+
+    if (!options.savePath.empty()) {
+        if (!saveBaseline(options.savePath, results)) {
+            cerr << "기준값 파일을 쓸 수 없습니다: " << options.savePath << endl;
+            return 1;
+        }
+        cout << "기준값 저장: " << options.savePath << endl;
+    }
+    else if (!compare) {
+        cout << "기준값 파일이 없어 비교하지 않았습니다: " << options.baselinePath << endl;
+    }
+    else if (regressions > 0) {
+        cout << regressions << "개 항목이 기준값보다 느려졌습니다 (기준 " << options.thresholdPercent << "%)" << endl;
+        return 1;
+    }
+    return 0;
+}
@@ -1,1045 +1,6797 @@
 // C++ Memory Visualizer - User Final Edition
 
 #include <iostream>
+#include <fstream>
 #include <vector>
+#include <deque>
 #include <string>
+#include <string_view>
 #include <sstream>
 #include <algorithm>
 #include <unordered_map>
 #include <functional>
+#include <iterator>
+#include <memory>
 #include <limits>
+#include <chrono>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
 #include <cstdlib>
+#include <cstdio>
+#include <cstring>
+#include <cstdint>
+#include <type_traits>
+#include <charconv>
+
+#include "memviz_preload.h"
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/ioctl.h>
+#include <unistd.h>
+#include <termios.h>
+#include <sys/select.h>
+#include <sys/wait.h>
+#else
+#include <conio.h>
+#include <io.h>
+#include <intrin.h>
+#endif
 
 using namespace std;
 
-// ==================== 메모리 블록 정의 ====================
+// ==================== 구간 프로파일러 ====================
+// MEMVIZ_PROFILE_SCOPE("이름")이 있는 블록의 실행 시간을 스레드별 버퍼에 모으고
+// --profile로 Chrome trace 이벤트 JSON과 구간별 p50/p99 요약을 출력
+// MEMVIZ_PROFILING이 0이면 매크로가 빈 문장이 되어 계측 코드가 아예 컴파일되지 않음 (CMake 빌드는 기본 1)
 
-enum class MemoryType {
-    STACK,
-    HEAP
-};
+#ifndef MEMVIZ_PROFILING
+#define MEMVIZ_PROFILING 0
+#endif
 
-enum class PointerType {
-    RAW
-};
+#if MEMVIZ_PROFILING
 
-class MemoryBlock {
+class Profiler {
 public:
-    int id;
-    string name;
-    size_t size;
-    MemoryType type;
-    void* address;
-    bool isAllocated;
-    int lifetime;
+    static constexpr int MAX_PHASES = 64;
+    static constexpr size_t MAX_EVENTS_PER_THREAD = 1 << 20;   // 넘는 이벤트는 요약에만 반영
+    static constexpr int BUCKET_COUNT = 512;
 
-    bool isPointer;
-    PointerType pointerType;
-    int pointsTo;
+private:
+    // 시각은 steady_clock 나노초
+    struct Event {
+        uint64_t start;
+        uint64_t duration;
+        uint32_t phase;
+    };
 
-    float x, y;
-    float targetX, targetY;
-    bool isHighlighted;
+    // 길이 분포는 한 옥타브를 8칸으로 나눈 로그 히스토그램이라 오래 돌려도 메모리가 늘지 않음
+    // (분위수 오차는 칸 폭의 절반, 약 6%)
+    struct PhaseStats {
+        uint64_t count = 0;
+        uint64_t totalNs = 0;
+        uint64_t minNs = UINT64_MAX;
+        uint64_t maxNs = 0;
+        uint64_t buckets[BUCKET_COUNT] = {};
+
+        void add(uint64_t ns) {
+            count++;
+            totalNs += ns;
+            minNs = min(minNs, ns);
+            maxNs = max(maxNs, ns);
+            buckets[bucketOf(ns)]++;
+        }
 
-    MemoryBlock()
-        : id(-1), name(""), size(0), type(MemoryType::STACK),
-        address(nullptr), isAllocated(false), lifetime(0),
-        isPointer(false), pointerType(PointerType::RAW),
-        pointsTo(-1),
-        x(0), y(0), targetX(0), targetY(0), isHighlighted(false) {
-    }
-};
+        void merge(const PhaseStats& other) {
+            count += other.count;
+            totalNs += other.totalNs;
+            minNs = min(minNs, other.minNs);
+            maxNs = max(maxNs, other.maxNs);
+            for (int i = 0; i < BUCKET_COUNT; i++) buckets[i] += other.buckets[i];
+        }
 
-class MemoryEvent {
-public:
-    enum class EventType {
-        ALLOCATE,
-        DEALLOCATE,
-        ASSIGN,
-        LEAK
+        // 분위수 q에 해당하는 칸의 가운데 값 (관측된 최소/최대를 넘지 않게)
+        uint64_t percentile(double q) const {
+            uint64_t rank = max<uint64_t>(1, (uint64_t)(q * (double)count + 0.999999));
+            uint64_t seen = 0;
+            for (int i = 0; i < BUCKET_COUNT; i++) {
+                seen += buckets[i];
+                if (seen >= rank) return min(maxNs, max(minNs, bucketMiddle(i)));
+            }
+            return maxNs;
+        }
     };
 
-    EventType type;
-    int blockId;
-    string description;
-    float timestamp;
+    // 스레드마다 하나, 스레드가 끝나도 보고서를 쓸 때까지 남아 있음
+    struct ThreadBuffer {
+        uint32_t index = 0;
+        bool isMain = false;
+        vector<Event> events;
+        uint64_t dropped = 0;
+        unique_ptr<PhaseStats> phases[MAX_PHASES];
+    };
 
-    MemoryEvent(EventType t, int id, const string& desc, float time)
-        : type(t), blockId(id), description(desc), timestamp(time) {
+    static inline atomic<bool> enabled{ false };
+    static inline mutex registryMutex;
+    static inline vector<const char*> phaseNames;
+    static inline vector<unique_ptr<ThreadBuffer>> buffers;
+    static inline uint64_t origin = 0;
+    static inline thread::id mainThread;
+
+    static int highestBit(uint64_t value) {
+#ifdef _MSC_VER
+        unsigned long index;
+        _BitScanReverse64(&index, value);
+        return (int)index;
+#else
+        return 63 - __builtin_clzll(value);
+#endif
     }
-};
-
-// ==================== 메모리 관리자 ====================
 
-class MemoryManager {
-private:
-    vector<MemoryBlock> blocks;
-    vector<MemoryEvent> events;
-    int nextId;
-    int stackDepth;
-    float currentTime;
-
-    void addEvent(MemoryEvent::EventType type, int blockId, const string& description) {
-        events.push_back(MemoryEvent(type, blockId, description, currentTime));
-        currentTime += 1.0f;
+    // 8 미만은 그대로, 그 위로는 옥타브마다 8칸
+    static int bucketOf(uint64_t ns) {
+        if (ns < 8) return (int)ns;
+        int octave = highestBit(ns);
+        return (octave - 2) * 8 + (int)((ns >> (octave - 3)) & 7);
     }
 
-public:
-    // 메모리 관리자 초기화
-    MemoryManager() : nextId(1), stackDepth(0), currentTime(0.0f) {}
-
-    // 스택 변수 생성 (지역 변수)
-    int createStackVariable(const string& name, size_t size) {
-        MemoryBlock block;
-        block.id = nextId++;
-        block.name = name;
-        block.size = size;
-        block.type = MemoryType::STACK;
-        block.address = (void*)(0x7fff0000 + blocks.size() * 8);
-        block.isAllocated = true;
-        block.isPointer = false;
-        blocks.push_back(block);
-        stackDepth++;
-
-        addEvent(MemoryEvent::EventType::ALLOCATE, block.id,
-            "스택 변수 생성: " + name);
-
-        return block.id;
+    static uint64_t bucketMiddle(int bucket) {
+        if (bucket < 8) return (uint64_t)bucket;
+        int octave = bucket / 8 + 2;
+        uint64_t width = 1ULL << (octave - 3);
+        return (uint64_t)(8 + bucket % 8) * width + width / 2;
     }
 
-    // 힙 메모리 할당 (동적 메모리)
-    int allocateHeap(const string& name, size_t size, PointerType ptrType = PointerType::RAW) {
-        MemoryBlock block;
-        block.id = nextId++;
-        block.name = name;
-        block.size = size;
-        block.type = MemoryType::HEAP;
-        block.address = (void*)(0x10000000 + blocks.size() * 16);
-        block.isAllocated = true;
-        block.isPointer = false;
-        blocks.push_back(block);
-
-        addEvent(MemoryEvent::EventType::ALLOCATE, block.id,
-            "힙 메모리 할당: " + name);
+    static ThreadBuffer& threadBuffer() {
+        thread_local ThreadBuffer* buffer = nullptr;
+        if (!buffer) {
+            lock_guard<mutex> lock(registryMutex);
+            buffers.push_back(make_unique<ThreadBuffer>());
+            buffer = buffers.back().get();
+            buffer->index = (uint32_t)buffers.size() - 1;
+            buffer->isMain = this_thread::get_id() == mainThread;
+        }
+        return *buffer;
+    }
 
-        return block.id;
+    // Chrome trace는 마이크로초 단위이므로 나노초를 소수 셋째 자리까지
+    static void writeMicros(ostream& out, uint64_t ns) {
+        char digits[4] = { '.', 0, 0, 0 };
+        uint64_t fraction = ns % 1000;
+        digits[1] = (char)('0' + fraction / 100);
+        digits[2] = (char)('0' + fraction / 10 % 10);
+        digits[3] = (char)('0' + fraction % 10);
+        out << ns / 1000;
+        out.write(digits, 4);
     }
 
-    // 메모리 해제 (delete 수행)
-    bool deallocate(int blockId) {
-        for (auto& block : blocks) {
-            if (block.id == blockId && block.isAllocated) {
-                block.isAllocated = false;
+public:
+    static uint64_t now() {
+        return (uint64_t)chrono::duration_cast<chrono::nanoseconds>(
+            chrono::steady_clock::now().time_since_epoch()).count();
+    }
 
-                for (auto& b : blocks) {
-                    if (b.isPointer && b.pointsTo == blockId) {
-                        b.pointsTo = -1;
-                    }
-                }
+    static bool isEnabled() { return enabled.load(memory_order_relaxed); }
 
-                addEvent(MemoryEvent::EventType::DEALLOCATE, blockId,
-                    "메모리 해제: " + block.name);
+    static void enable() {
+        origin = now();
+        mainThread = this_thread::get_id();
+        enabled.store(true, memory_order_relaxed);
+    }
 
-                return true;
-            }
+    // 매크로가 호출 위치마다 한 번 등록 (같은 이름이면 같은 구간)
+    static int registerPhase(const char* name) {
+        lock_guard<mutex> lock(registryMutex);
+        for (size_t i = 0; i < phaseNames.size(); i++) {
+            if (strcmp(phaseNames[i], name) == 0) return (int)i;
         }
-        return false;
+        if (phaseNames.size() >= MAX_PHASES) return -1;
+        phaseNames.push_back(name);
+        return (int)phaseNames.size() - 1;
     }
 
-    // 포인터 변수에 주소 할당 (ptr = &var 또는 ptr = ptr2)
-    bool assignPointer(int pointerBlockId, int targetBlockId) {
-        for (auto& block : blocks) {
-            if (block.id == pointerBlockId) {
-                block.pointsTo = targetBlockId;
-
-                string targetName = (targetBlockId == -1) ? "nullptr" : findBlock(targetBlockId)->name;
-
-                addEvent(MemoryEvent::EventType::ASSIGN, pointerBlockId,
-                    "포인터 연결: " + block.name + " -> " + targetName);
-
-                return true;
-            }
+    static void record(int phase, uint64_t start, uint64_t end) {
+        if (phase < 0) return;
+        ThreadBuffer& buffer = threadBuffer();
+        uint64_t duration = end - start;
+        auto& stats = buffer.phases[phase];
+        if (!stats) stats = make_unique<PhaseStats>();
+        stats->add(duration);
+        if (buffer.events.size() < MAX_EVENTS_PER_THREAD) {
+            buffer.events.push_back({ start, duration, (uint32_t)phase });
+        }
+        else {
+            buffer.dropped++;
         }
-        return false;
     }
 
-    // 프로그램 종료 시 모든 스택 메모리 정리
-    void clearAllStack() {
-        for (auto& block : blocks) {
-            if (block.type == MemoryType::STACK && block.isAllocated) {
-                block.isAllocated = false;
-                addEvent(MemoryEvent::EventType::DEALLOCATE, block.id,
-                    "프로그램 종료로 변수 해제: " + block.name);
+    // 모든 작업 스레드가 끝난 뒤에 호출
+    static bool writeChromeTrace(const string& path) {
+        ofstream out(path, ios::binary | ios::trunc);
+        if (!out) return false;
+
+        out << "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[";
+        bool first = true;
+        for (const auto& buffer : buffers) {
+            out << (first ? "\n" : ",\n");
+            first = false;
+            out << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << buffer->index
+                << ",\"args\":{\"name\":\"";
+            if (buffer->isMain) out << "main";
+            else out << "worker " << buffer->index;
+            out << "\"}}";
+            for (const Event& event : buffer->events) {
+                out << ",\n{\"name\":\"" << phaseNames[event.phase]
+                    << "\",\"cat\":\"memviz\",\"ph\":\"X\",\"pid\":1,\"tid\":" << buffer->index << ",\"ts\":";
+                writeMicros(out, event.start >= origin ? event.start - origin : 0);
+                out << ",\"dur\":";
+                writeMicros(out, event.duration);
+                out << '}';
             }
         }
-        stackDepth = 0;
+        out << "\n]}\n";
+        return (bool)out;
     }
 
-    // 메모리 누수 감지 (해제되지 않은 힙 메모리 찾기)
-    vector<int> detectLeaks() const {
-        vector<int> leaks;
-        for (const auto& block : blocks) {
-            if (block.type == MemoryType::HEAP && block.isAllocated) {
-                bool hasPointer = false;
-                for (const auto& ptr : blocks) {
-                    if (ptr.isPointer && ptr.isAllocated && ptr.pointsTo == block.id) {
-                        hasPointer = true;
-                        break;
-                    }
-                }
-                if (!hasPointer) {
-                    leaks.push_back(block.id);
-                }
+    // 구간별 호출 수, 합계, p50/p99/최대 (안쪽 구간 시간도 포함한 값)
+    static void printSummary(ostream& out) {
+        vector<PhaseStats> totals(phaseNames.size());
+        uint64_t dropped = 0;
+        for (const auto& buffer : buffers) {
+            dropped += buffer->dropped;
+            for (size_t i = 0; i < phaseNames.size(); i++) {
+                if (buffer->phases[i]) totals[i].merge(*buffer->phases[i]);
             }
         }
-        return leaks;
-    }
 
-    // ID로 메모리 블록 찾기
-    MemoryBlock* findBlock(int id) {
-        for (auto& block : blocks) {
-            if (block.id == id) return &block;
+        vector<size_t> order;
+        for (size_t i = 0; i < totals.size(); i++) {
+            if (totals[i].count > 0) order.push_back(i);
         }
-        return nullptr;
-    }
+        sort(order.begin(), order.end(), [&](size_t a, size_t b) { return totals[a].totalNs > totals[b].totalNs; });
+
+        size_t nameWidth = 4;
+        for (size_t i : order) nameWidth = max(nameWidth, strlen(phaseNames[i]));
 
-    const MemoryBlock* findBlock(int id) const {
-        for (const auto& block : blocks) {
-            if (block.id == id) return &block;
+        // 한글은 두 칸으로 쳐서 맞춤
+        auto pad = [](const string& text, size_t width, bool left) {
+            size_t shown = 0;
+            for (unsigned char ch : text) {
+                if ((ch & 0xC0) != 0x80) shown += ch >= 0xE0 ? 2 : 1;
+            }
+            if (shown >= width) return text + ' ';
+            string spaces(width - shown, ' ');
+            return left ? text + spaces + ' ' : spaces + text + ' ';
+        };
+        auto micros = [](uint64_t ns) {
+            char text[32];
+            snprintf(text, sizeof(text), "%.3f", ns / 1000.0);
+            return string(text);
+        };
+
+        out << "구간 프로파일 (포함 시간, 마이크로초, 스레드 " << buffers.size() << "개)\n";
+        out << pad("구간", nameWidth + 2, true) << pad("횟수", 12, false) << pad("합계(ms)", 12, false)
+            << pad("p50", 12, false) << pad("p99", 12, false) << pad("최대", 12, false) << '\n';
+        for (size_t i : order) {
+            const PhaseStats& stats = totals[i];
+            char total[32];
+            snprintf(total, sizeof(total), "%.3f", stats.totalNs / 1e6);
+            out << pad(phaseNames[i], nameWidth + 2, true) << pad(to_string(stats.count), 12, false)
+                << pad(total, 12, false) << pad(micros(stats.percentile(0.5)), 12, false)
+                << pad(micros(stats.percentile(0.99)), 12, false) << pad(micros(stats.maxNs), 12, false) << '\n';
+        }
+        if (dropped > 0) {
+            out << "Chrome trace에서 빠진 이벤트 " << dropped << "개 (스레드당 " << MAX_EVENTS_PER_THREAD
+                << "개까지 기록, 요약에는 포함)\n";
         }
-        return nullptr;
     }
+};
+
+// 생성부터 소멸까지를 한 구간으로 기록 (꺼져 있으면 시계를 읽지 않음)
+class ProfileScope {
+private:
+    int phase;
+    uint64_t start;
+    bool active;
 
-    const vector<MemoryBlock>& getMemoryBlocks() const { return blocks; }
-    const vector<MemoryEvent>& getEvents() const { return events; }
+public:
+    explicit ProfileScope(int phase)
+        : phase(phase), start(0), active(Profiler::isEnabled()) {
+        if (active) start = Profiler::now();
+    }
+    ProfileScope(const ProfileScope&) = delete;
+    ProfileScope& operator=(const ProfileScope&) = delete;
 
-    // 메모리 관리자 초기화 (모든 데이터 삭제)
-    void reset() {
-        blocks.clear();
-        events.clear();
-        nextId = 1;
-        stackDepth = 0;
-        currentTime = 0.0f;
+    ~ProfileScope() {
+        if (active) Profiler::record(phase, start, Profiler::now());
     }
 };
 
-// ==================== 화면 출력 ====================
-
-class Visualizer {
-private:
-    string colorReset = "\033[0m";
-    string colorRed = "\033[31m";
-    string colorGreen = "\033[32m";
-    string colorYellow = "\033[33m";
-    string colorBlue = "\033[34m";
-    string colorMagenta = "\033[35m";
-    string colorCyan = "\033[36m";
-    string colorBold = "\033[1m";
+// --profile 보고서 (main이 어느 경로로 끝나든 소멸자에서 씀)
+struct ProfileReport {
+    string path;
 
-    void printSeparator(char ch, int width) const {
-        for (int i = 0; i < width; i++) {
-            cout << ch;
+    ~ProfileReport() {
+        if (path.empty()) return;
+        if (!Profiler::writeChromeTrace(path)) {
+            cerr << "프로파일 파일을 쓸 수 없습니다: " << path << endl;
         }
-        cout << endl;
+        Profiler::printSummary(cerr);
     }
+};
 
-    // 스택 메모리 영역 출력
-    void printStack(const vector<MemoryBlock>& blocks) const {
-        bool hasStack = false;
-        for (const auto& block : blocks) {
-            if (block.type == MemoryType::STACK && block.isAllocated) {
-                hasStack = true;
-                cout << "│ " << colorBlue;
-                cout << block.name;
-                for (size_t i = block.name.length(); i < 15; i++) cout << " ";
+#define MEMVIZ_PROFILE_CONCAT_(a, b) a##b
+#define MEMVIZ_PROFILE_CONCAT(a, b) MEMVIZ_PROFILE_CONCAT_(a, b)
+#define MEMVIZ_PROFILE_SCOPE(name) \
+    static const int MEMVIZ_PROFILE_CONCAT(profilePhase_, __LINE__) = Profiler::registerPhase(name); \
+    ProfileScope MEMVIZ_PROFILE_CONCAT(profileScope_, __LINE__)(MEMVIZ_PROFILE_CONCAT(profilePhase_, __LINE__))
 
-                if (block.isPointer) {
-                    cout << " [ptr]          ";
-                }
-                else {
-                    cout << " [val]          ";
-                }
+#else
 
-                cout << block.size << "bytes";
-                cout << colorReset << endl;
-            }
-        }
+#define MEMVIZ_PROFILE_SCOPE(name) ((void)0)
 
-        if (!hasStack) {
-            cout << "│ (비어있음)" << endl;
-        }
-    }
+#endif // MEMVIZ_PROFILING
 
-    // 힙 메모리 영역 출력
-    void printHeap(const vector<MemoryBlock>& blocks) const {
-        bool hasHeap = false;
-        for (const auto& block : blocks) {
-            if (block.type == MemoryType::HEAP && block.isAllocated) {
-                hasHeap = true;
-                cout << "│ " << colorRed;
-                cout << block.name;
-                for (size_t i = block.name.length(); i < 30; i++) cout << " ";
-                cout << block.size << "bytes";
-                cout << colorReset << endl;
-            }
-        }
+// ==================== 메모리 블록 정의 ====================
 
-        if (!hasHeap) {
-            cout << "│ (비어있음)" << endl;
-        }
-    }
+enum class MemoryType : unsigned char {
+    STACK,
+    HEAP
+};
 
-    // 포인터 연결 관계 출력 (ptr -> data)
-    void printPointerConnections(const vector<MemoryBlock>& blocks) const {
-        bool hasConnections = false;
-        for (const auto& block : blocks) {
-            if (block.isPointer && block.isAllocated && block.pointsTo != -1) {
-                hasConnections = true;
-                const MemoryBlock* target = nullptr;
-                for (const auto& b : blocks) {
-                    if (b.id == block.pointsTo) {
-                        target = &b;
-                        break;
-                    }
-                }
+enum class PointerType {
+    RAW
+};
 
-                cout << "  " << colorYellow << block.name << colorReset;
-                cout << " ──> ";
+// 누수 판정 방식
+enum class LeakMode {
+    DIRECT_REFERENCE,   // 살아있는 포인터가 직접 가리키지 않는 힙 블록
+    REACHABILITY        // 스택 루트에서 포인터를 따라 도달할 수 없는 힙 블록
+};
 
-                if (target && target->isAllocated) {
-                    if (target->type == MemoryType::HEAP)
-                        cout << colorRed << target->name << colorReset;
-                    else
-                        cout << colorBlue << target->name << " (Stack)" << colorReset;
-                }
-                else {
-                    cout << colorRed << "(dangling)" << colorReset;
-                }
-                cout << endl;
-            }
+// 이름 문자열 저장소 (같은 이름은 한 번만 저장하고 ID로 참조)
+// 고정 크기 청크에 이어 붙이므로 이미 저장된 문자열의 위치는 바뀌지 않음
+class StringArena {
+private:
+    static constexpr size_t CHUNK_SIZE = 64 * 1024;
+
+    vector<unique_ptr<char[]>> chunks;
+    vector<unique_ptr<char[]>> largeStrings;
+    size_t chunkUsed;
+    vector<string_view> strings;
+    unordered_map<string_view, uint32_t> index;
+
+    const char* store(string_view text) {
+        if (text.empty()) return "";
+        if (text.size() > CHUNK_SIZE) {
+            largeStrings.push_back(make_unique<char[]>(text.size()));
+            text.copy(largeStrings.back().get(), text.size());
+            return largeStrings.back().get();
         }
-
-        if (!hasConnections) {
-            cout << "  (포인터 연결 없음)" << endl;
+        if (chunks.empty() || chunkUsed + text.size() > CHUNK_SIZE) {
+            chunks.push_back(make_unique<char[]>(CHUNK_SIZE));
+            chunkUsed = 0;
         }
+        char* dest = chunks.back().get() + chunkUsed;
+        text.copy(dest, text.size());
+        chunkUsed += text.size();
+        return dest;
     }
 
-    // 이벤트 로그 출력 (최근 count개)
-    void printEventLog(const vector<MemoryEvent>& events, int count) const {
-        int startIdx = (int)events.size() - count;
-        if (startIdx < 0) startIdx = 0;
+public:
+    StringArena() : chunkUsed(0) {}
+    StringArena(const StringArena&) = delete;
+    StringArena& operator=(const StringArena&) = delete;
+
+    // 문자열을 등록하고 ID 반환 (이미 있으면 기존 ID, 할당 없음)
+    uint32_t intern(string_view text) {
+        auto it = index.find(text);
+        if (it != index.end()) return it->second;
+
+        string_view stored(store(text), text.size());
+        uint32_t id = (uint32_t)strings.size();
+        strings.push_back(stored);
+        index.emplace(stored, id);
+        return id;
+    }
 
-        for (size_t i = startIdx; i < events.size(); i++) {
-            const auto& event = events[i];
+    string_view get(uint32_t id) const {
+        return id < strings.size() ? strings[id] : string_view();
+    }
 
-            switch (event.type) {
-            case MemoryEvent::EventType::ALLOCATE:
-                cout << "  " << colorGreen << "[ALLOC]  " << colorReset;
-                break;
-            case MemoryEvent::EventType::DEALLOCATE:
-                cout << "  " << colorRed << "[FREE]   " << colorReset;
-                break;
-            case MemoryEvent::EventType::ASSIGN:
-                cout << "  " << colorYellow << "[ASSIGN] " << colorReset;
-                break;
-            case MemoryEvent::EventType::LEAK:
-                cout << "  " << colorRed << "[LEAK]   " << colorReset;
-                break;
-            }
+    size_t count() const { return strings.size(); }
 
-            cout << event.description << endl;
-        }
+    // 청크 메모리는 재사용하기 위해 첫 청크만 남김
+    void clear() {
+        if (chunks.size() > 1) chunks.resize(1);
+        largeStrings.clear();
+        chunkUsed = 0;
+        strings.clear();
+        index.clear();
     }
+};
+
+// 블록 생성/등록에 쓰는 평면 레코드
+struct BlockRecord {
+    int id = -1;
+    string_view name;
+    size_t size = 0;
+    MemoryType type = MemoryType::STACK;
+    void* address = nullptr;
+    bool isAllocated = false;
+    bool isPointer = false;
+    PointerType pointerType = PointerType::RAW;
+    int pointsTo = -1;
+    // 할당자 모델이 정한 주소 (해제 시 모델에 돌려줌)
+    bool simulatedAddress = false;
+};
+
+// 순회 중에는 거의 읽지 않는 필드 (이름, 주소, 애니메이션 좌표)
+// 쓰기 시 복사(copy-on-write) 배열
+// 고정 크기 청크를 shared_ptr로 공유하므로 배열 복사는 청크 포인터만 복사하고,
+// 공유 중인 청크에 처음 쓸 때 그 청크 하나만 복제함 (체크포인트를 싸게 만들기 위함)
+// 읽기는 const operator[], 쓰기는 set()/ref()로 구분해서 읽기만으로는 복제되지 않게 함
+template <typename T>
+class CowVector {
+private:
+    static constexpr size_t CHUNK_SHIFT = 8;
+    static constexpr size_t CHUNK_SIZE = size_t(1) << CHUNK_SHIFT;
+    static constexpr size_t CHUNK_MASK = CHUNK_SIZE - 1;
+
+    struct Chunk {
+        T items[CHUNK_SIZE];
+    };
+
+    vector<shared_ptr<Chunk>> chunks;
+    size_t count = 0;
 
 public:
-    // 화면 지우기
-    void clearScreen() const {
-#ifdef _WIN32
-        system("cls");
-#else
-        system("clear");
-#endif
-    }
+    class const_iterator {
+    private:
+        const CowVector* owner;
+        size_t index;
+
+    public:
+        using iterator_category = forward_iterator_tag;
+        using value_type = T;
+        using difference_type = ptrdiff_t;
+        using pointer = const T*;
+        using reference = const T&;
+
+        const_iterator(const CowVector* v, size_t i) : owner(v), index(i) {}
+        const T& operator*() const { return (*owner)[index]; }
+        const_iterator& operator++() { index++; return *this; }
+        bool operator!=(const const_iterator& other) const { return index != other.index; }
+        bool operator==(const const_iterator& other) const { return index == other.index; }
+    };
 
-    // 메모리 누수 경고 출력
-    void printLeakWarnings(const vector<int>& leaks, const MemoryManager& memManager) const {
-        if (leaks.empty()) return;
+    size_t size() const { return count; }
+    bool empty() const { return count == 0; }
 
-        cout << colorBold << colorRed;
-        cout << "!! 메모리 누수 감지 !! " << leaks.size() << "개 블록" << colorReset << endl;
+    const T& operator[](size_t i) const { return chunks[i >> CHUNK_SHIFT]->items[i & CHUNK_MASK]; }
+    const T& back() const { return (*this)[count - 1]; }
 
-        for (int id : leaks) {
-            const MemoryBlock* block = memManager.findBlock(id);
-            if (block) {
-                cout << "  - " << colorRed << block->name << " (" << block->size << " bytes, @"
-                    << block->address << ")" << colorReset << endl;
-            }
-        }
+    // 쓰기용 참조 (다른 복사본과 공유 중인 청크면 먼저 복제)
+    T& ref(size_t i) {
+        shared_ptr<Chunk>& chunk = chunks[i >> CHUNK_SHIFT];
+        if (chunk.use_count() > 1) chunk = make_shared<Chunk>(*chunk);
+        return chunk->items[i & CHUNK_MASK];
     }
 
-    // 전체 메모리 상태 출력 (최종 결과 화면)
-    void printMemoryState(const MemoryManager& memManager) const {
-        clearScreen();
+    void set(size_t i, const T& value) { ref(i) = value; }
 
-        cout << colorBold << colorCyan;
-        printSeparator('=', 70);
-        cout << "        C++ 메모리 관리 시각화 도구 - 콘솔 버전" << endl;
-        printSeparator('=', 70);
-        cout << colorReset << endl;
+    void push_back(const T& value) {
+        if ((count >> CHUNK_SHIFT) == chunks.size()) chunks.push_back(make_shared<Chunk>());
+        ref(count) = value;
+        count++;
+    }
 
-        const auto& blocks = memManager.getMemoryBlocks();
+    void pop_back() { count--; }
 
-        auto leaks = memManager.detectLeaks();
-        if (!leaks.empty()) {
-            printLeakWarnings(leaks, memManager);
-            cout << endl;
-        }
+    void resize(size_t n, const T& value) {
+        while (count < n) push_back(value);
+        count = n;
+    }
 
-        cout << colorBold << colorBlue << "┌─ STACK 메모리 ─────────────────┐" << colorReset << endl;
-        printStack(blocks);
-        cout << colorBlue << "└─────────────────────────────────┘" << colorReset << endl;
-        cout << endl;
+    void assign(size_t n, const T& value) {
+        count = 0;
+        resize(n, value);
+    }
 
-        cout << colorBold << colorRed << "┌─ HEAP 메모리 ──────────────────┐" << colorReset << endl;
-        printHeap(blocks);
-        cout << colorRed << "└─────────────────────────────────┘" << colorReset << endl;
-        cout << endl;
+    // 청크는 남겨두고 다시 채울 때 재사용 (공유 중인 청크는 쓸 때 복제됨)
+    void clear() { count = 0; }
 
-        cout << colorBold << colorYellow << "포인터 연결:" << colorReset << endl;
-        printPointerConnections(blocks);
-        cout << endl;
+    const_iterator begin() const { return const_iterator(this, 0); }
+    const_iterator end() const { return const_iterator(this, count); }
+};
 
-        cout << colorBold << colorGreen << "최근 이벤트:" << colorReset << endl;
-        printEventLog(memManager.getEvents(), 15);
-        cout << endl;
+struct BlockColdData {
+    uint32_t nameId;
+    void* address;
+    int lifetime;
+    PointerType pointerType;
+    float x, y;
+    float targetX, targetY;
+    bool isHighlighted;
+    bool simulatedAddress;
+};
 
-        printSeparator('-', 70);
+// 메모리 블록 저장소 (Struct-of-Arrays)
+// 누수/스택/힙 순회는 hot 열만 읽고, 이름 등은 출력할 블록에 대해서만 cold 열에서 읽음
+class BlockStore {
+public:
+    CowVector<int> id;
+    CowVector<MemoryType> type;
+    CowVector<unsigned char> allocated;
+    CowVector<unsigned char> pointer;
+    CowVector<int> pointsTo;
+    CowVector<size_t> size;
+
+    CowVector<BlockColdData> cold;
+    StringArena names;
+
+    size_t count() const { return id.size(); }
+    string_view name(int slot) const { return names.get(cold[slot].nameId); }
+
+    int append(const BlockRecord& record) {
+        int slot = (int)id.size();
+        id.push_back(record.id);
+        type.push_back(record.type);
+        allocated.push_back(record.isAllocated);
+        pointer.push_back(record.isPointer);
+        pointsTo.push_back(record.pointsTo);
+        size.push_back(record.size);
+        cold.push_back(BlockColdData{ names.intern(record.name), record.address, 0, record.pointerType,
+            0, 0, 0, 0, false, record.simulatedAddress });
+        return slot;
     }
 
-    // 메모리 상태 출력 (단계별 실행 화면 - 현재 실행 라인 표시)
-    void printMemoryStateWithLine(const MemoryManager& memManager,
-        const string& currentLine,
-        int lineNumber) const {
-        clearScreen();
-
-        cout << colorBold << colorCyan;
-        printSeparator('=', 70);
-        cout << "        C++ 메모리 관리 시각화 도구 - 단계별 실행" << endl;
-        printSeparator('=', 70);
-        cout << colorReset << endl;
-
-        cout << colorBold << colorMagenta << "▶ 현재 실행 라인 " << lineNumber << ": " << colorReset;
-        cout << colorYellow << currentLine << colorReset << endl;
-        cout << endl;
-
-        const auto& blocks = memManager.getMemoryBlocks();
+    void clear() {
+        id.clear();
+        type.clear();
+        allocated.clear();
+        pointer.clear();
+        pointsTo.clear();
+        size.clear();
+        cold.clear();
+        names.clear();
+    }
+};
 
-        auto leaks = memManager.detectLeaks();
-        if (!leaks.empty()) {
-            printLeakWarnings(leaks, memManager);
-            cout << endl;
-        }
+// 저장소의 블록 하나를 가리키는 읽기 전용 뷰
+// slot 번호만 들고 있으므로 이후 할당으로 열이 재배치되어도 계속 유효함
+class MemoryBlock {
+private:
+    const BlockStore* store;
+    int slot;
 
-        cout << colorBold << colorBlue << "┌─ STACK 메모리 ─────────────────┐" << colorReset << endl;
-        printStack(blocks);
-        cout << colorBlue << "└────────────────────────────────┘" << colorReset << endl;
-        cout << endl;
+public:
+    MemoryBlock() : store(nullptr), slot(-1) {}
+    MemoryBlock(const BlockStore* s, int index) : store(s), slot(index) {}
+
+    explicit operator bool() const { return store != nullptr; }
+
+    int id() const { return store->id[slot]; }
+    string_view name() const { return store->name(slot); }
+    size_t size() const { return store->size[slot]; }
+    MemoryType type() const { return store->type[slot]; }
+    void* address() const { return store->cold[slot].address; }
+    bool isAllocated() const { return store->allocated[slot] != 0; }
+    bool isPointer() const { return store->pointer[slot] != 0; }
+    PointerType pointerType() const { return store->cold[slot].pointerType; }
+    int pointsTo() const { return store->pointsTo[slot]; }
+};
 
-        cout << colorBold << colorRed << "┌─ HEAP 메모리 ──────────────────┐" << colorReset << endl;
-        printHeap(blocks);
-        cout << colorRed << "└────────────────────────────────┘" << colorReset << endl;
-        cout << endl;
+// 메모리 이벤트 (고정 크기 POD 레코드)
+// 설명 문구는 저장하지 않고 출력할 때 detail과 이름 ID로 조립함
+class MemoryEvent {
+public:
+    enum class EventType : unsigned char {
+        ALLOCATE,
+        DEALLOCATE,
+        ASSIGN,
+        LEAK
+    };
 
-        cout << colorBold << colorYellow << "포인터 연결:" << colorReset << endl;
-        printPointerConnections(blocks);
-        cout << endl;
+    enum class Detail : unsigned char {
+        STACK_CREATE,
+        HEAP_ALLOCATE,
+        FREE,
+        EXIT_FREE,
+        POINTER_ASSIGN,
+        UNREACHABLE,
+        SCOPE_FREE
+    };
 
-        cout << colorBold << colorGreen << "최근 이벤트:" << colorReset << endl;
-        printEventLog(memManager.getEvents(), 15);
-        cout << endl;
+    static constexpr uint64_t NO_EVENT = UINT64_MAX;
 
-        printSeparator('-', 70);
-        cout << colorGreen << "▶ Enter를 누르면 다음 단계로 진행합니다..." << colorReset << endl;
+    EventType type;
+    Detail detail;
+    // 해제 이벤트일 때 이 블록을 가리키던 포인터 수
+    // (delete면 모두 nullptr이 되고, 스택 변수 해제면 해제된 변수를 가리킨 채로 남음)
+    uint16_t affectedPointers;
+    int blockId;
+    int targetId;
+    uint32_t nameId;
+    uint64_t timestamp;
+    // 블록별 기록 사슬: 같은 블록의 직전 이벤트, ASSIGN이면 같은 대상을 가리킨 직전 ASSIGN의 전체 인덱스
+    uint64_t prevOfBlock;
+    uint64_t prevOfTarget;
+
+    // 이벤트 로그용 종류 표시 (폭 9칸)
+    static const char* typeTag(EventType type) {
+        switch (type) {
+        case EventType::ALLOCATE: return "[ALLOC]  ";
+        case EventType::DEALLOCATE: return "[FREE]   ";
+        case EventType::ASSIGN: return "[ASSIGN] ";
+        case EventType::LEAK: return "[LEAK]   ";
+        }
+        return "";
     }
 };
 
-// ==================== 코드 파서 ==================== 
+static_assert(is_trivially_copyable<MemoryEvent>::value, "MemoryEvent must stay POD");
 
-class ScriptParser {
+// ==================== 이벤트 기록 ====================
+
+// 이벤트 보존 정책: 최근 capacity개는 링 버퍼에, 그보다 오래된 이벤트는
+// spillPath가 지정된 경우에만 고정 길이 레코드로 디스크에 기록함
+class EventHistory {
 private:
-    MemoryManager& memManager;
-    unordered_map<string, int> variables;
-    int scopeLevel;
+    static constexpr char SPILL_MAGIC[8] = { 'M', 'V', 'S', 'P', 'I', 'L', 'L', '1' };
+    static constexpr long long SPILL_HEADER_SIZE = 16;
+
+    vector<MemoryEvent> ring;
+    size_t capacity;
+    size_t mask;
+    size_t retained;
+    uint64_t total;
+
+    string spillPath;
+    FILE* spillFile;
+    uint64_t spilledCount;
+    // 쓰기에 한 번 실패하면 더 쓰지 않음 (이후 기록이 한 칸씩 밀려 인덱스와 파일 위치가 어긋나지 않게)
+    bool spillStopped;
+
+    static size_t roundUpPow2(size_t value) {
+        size_t result = 1;
+        while (result < value) result <<= 1;
+        return result;
+    }
 
-    vector<string> splitIntoLines(const string& code) {
-        vector<string> lines;
-        istringstream stream(code);
-        string line;
-        while (getline(stream, line)) {
-            lines.push_back(line);
-        }
-        return lines;
+    static bool seekTo(FILE* file, long long offset) {
+#ifdef _WIN32
+        return _fseeki64(file, offset, SEEK_SET) == 0;
+#else
+        return fseeko(file, (off_t)offset, SEEK_SET) == 0;
+#endif
     }
 
-    string removeComments(const string& line) {
-        size_t pos = line.find("//");
-        if (pos != string::npos) {
-            return line.substr(0, pos);
-        }
-        return line;
+    void openSpill() {
+        closeSpill();
+        if (spillPath.empty()) return;
+        spillFile = fopen(spillPath.c_str(), "w+b");
+        if (!spillFile) return;
+
+        char header[SPILL_HEADER_SIZE] = {};
+        memcpy(header, SPILL_MAGIC, sizeof(SPILL_MAGIC));
+        uint32_t recordSize = sizeof(MemoryEvent);
+        memcpy(header + 8, &recordSize, sizeof(recordSize));
+        if (fwrite(header, 1, sizeof(header), spillFile) != sizeof(header)) stopSpill();
     }
 
-    string trim(const string& str) {
-        size_t first = str.find_first_not_of(" \t\r\n");
-        if (first == string::npos) return "";
-        size_t last = str.find_last_not_of(" \t\r\n");
-        return str.substr(first, last - first + 1);
+    void closeSpill() {
+        if (spillFile) fclose(spillFile);
+        spillFile = nullptr;
+        spilledCount = 0;
+        spillStopped = false;
     }
 
-    vector<string> tokenize(const string& line) {
-        vector<string> tokens;
-        string current;
-        for (char ch : line) {
-            if (isspace(ch) || ch == ';' || ch == '(' || ch == ')' || ch == '{' || ch == '}') {
-                if (!current.empty()) {
-                    tokens.push_back(current);
-                    current.clear();
-                }
-            }
-            else {
-                current += ch;
-            }
+    // 이미 기록한 앞부분은 계속 읽을 수 있게 파일은 열어 둠
+    // 버퍼에 있다가 함께 잃은 기록은 세지 않도록 파일에 실제로 남은 개수로 줄임
+    void stopSpill() {
+        spillStopped = true;
+#ifndef _WIN32
+        struct stat info;
+        if (spillFile && fstat(fileno(spillFile), &info) == 0) {
+            uint64_t onDisk = info.st_size > SPILL_HEADER_SIZE
+                ? (uint64_t)(info.st_size - SPILL_HEADER_SIZE) / sizeof(MemoryEvent) : 0;
+            if (spilledCount > onDisk) spilledCount = onDisk;
         }
-        if (!current.empty()) {
-            tokens.push_back(current);
-        }
-        return tokens;
+#endif
+        cerr << "[WARN] 이벤트 기록 파일에 쓸 수 없어 디스크 기록을 멈춥니다: " << spillPath << ": "
+            << strerror(errno) << endl;
     }
 
-    bool isBasicType(const string& type) {
-        string t = type;
-        t.erase(remove(t.begin(), t.end(), '*'), t.end());
-        return t == "int" || t == "float" || t == "double" ||
-            t == "char" || t == "bool" || t == "long" || t == "short";
+public:
+    explicit EventHistory(size_t retained = 4096)
+        : capacity(0), mask(0), retained(0), total(0), spillFile(nullptr), spilledCount(0), spillStopped(false) {
+        setRetention(retained, "");
     }
 
-    size_t getTypeSize(const string& type) {
-        if (type.find("int") != string::npos) return 4;
-        if (type.find("double") != string::npos) return 8;
-        if (type.find("float") != string::npos) return 4;
-        if (type.find("char") != string::npos) return 1;
-        if (type.find("long") != string::npos) return 8;
-        if (type.find("short") != string::npos) return 2;
-        if (type.find("bool") != string::npos) return 1;
-        return 4;
+    ~EventHistory() { closeSpill(); }
+
+    EventHistory(const EventHistory&) = delete;
+    EventHistory& operator=(const EventHistory&) = delete;
+
+    // 보존 개수(2의 거듭제곱으로 올림)와 디스크 기록 경로 설정, 기존 기록은 비움
+    void setRetention(size_t retained, const string& path) {
+        capacity = roundUpPow2(retained < 16 ? 16 : retained);
+        mask = capacity - 1;
+        ring.clear();
+        ring.shrink_to_fit();
+        retained = 0;
+        total = 0;
+        spillPath = path;
+        openSpill();
     }
 
-    // 변수 선언 파싱 (int* ptr; 등)
-    bool parseDeclaration(const string& line) {
-        auto tokens = tokenize(line);
-        if (tokens.size() < 2) return false;
-
-        string type = tokens[0];
-        string name = tokens[1];
-
-        if (!name.empty() && name.back() == ';') {
-            name.pop_back();
+    void push(const MemoryEvent& event) {
+        size_t pos = total & mask;
+        if (pos == ring.size()) {
+            ring.push_back(event);
         }
+        else {
+            MemoryEvent& slot = ring[pos];
+            // 덮어쓰기 직전에 가장 오래된 이벤트를 디스크로 내보냄
+            if (retained == capacity && spillFile && !spillStopped) {
+                if (fwrite(&slot, sizeof(MemoryEvent), 1, spillFile) == 1) spilledCount++;
+                else stopSpill();
+            }
+            slot = event;
+        }
+        if (retained < capacity) retained++;
+        total++;
+    }
 
-        while (!name.empty() && name[0] == '*') {
-            type += "*";
-            name = name.substr(1);
+    // 앞쪽 count개만 남기고 이후 기록을 버림 (체크포인트 복원용)
+    // 링 버퍼에서 이미 밀려난 이벤트는 디스크 기록이 있을 때만 다시 읽을 수 있음
+    void truncate(uint64_t count) {
+        if (count >= total) return;
+        uint64_t dropped = total - count;
+        retained = dropped >= retained ? 0 : retained - (size_t)dropped;
+        total = count;
+        if (spillFile) {
+            if (spilledCount > count) spilledCount = count;
+            seekTo(spillFile, SPILL_HEADER_SIZE + (long long)(spilledCount * sizeof(MemoryEvent)));
         }
+    }
 
-        bool isPtr = (type.find('*') != string::npos);
+    // 지금까지 기록된 전체 이벤트 수
+    uint64_t totalCount() const { return total; }
+    // 메모리에 남아있는 이벤트 수
+    size_t size() const { return retained; }
+    size_t getCapacity() const { return capacity; }
+    bool empty() const { return total == 0; }
+    // 메모리에 남아있는 가장 오래된 이벤트의 전체 인덱스
+    uint64_t firstRetained() const { return total - retained; }
+    // 디스크에 기록된 이벤트 수 (인덱스 0부터 연속)
+    uint64_t spilled() const { return spilledCount; }
+    const string& getSpillPath() const { return spillPath; }
+
+    // 전체 인덱스로 메모리에 남은 이벤트 참조 (firstRetained() 이상이어야 함)
+    const MemoryEvent& at(uint64_t index) const { return ring[index & mask]; }
+
+    // 전체 인덱스로 이벤트 읽기 (메모리에 없으면 디스크 기록에서 읽음)
+    // 디스크 기록은 위치 지정 읽기라 쓰기 위치를 건드리지 않음 (버퍼에 남은 기록만 먼저 내보냄)
+    bool read(uint64_t index, MemoryEvent& out) const {
+        if (index >= total) return false;
+        if (index >= firstRetained()) {
+            out = at(index);
+            return true;
+        }
+        if (!spillFile || index >= spilledCount) return false;
+        if (fflush(spillFile) != 0) return false;
 
-        size_t size = isPtr ? sizeof(void*) : getTypeSize(type);
+        long long offset = SPILL_HEADER_SIZE + (long long)(index * sizeof(MemoryEvent));
+#ifdef _WIN32
+        // pread가 없으므로 읽은 뒤 쓰기 위치(기록 끝)를 되돌려 놓음
+        bool ok = seekTo(spillFile, offset) && fread(&out, sizeof(MemoryEvent), 1, spillFile) == 1;
+        seekTo(spillFile, SPILL_HEADER_SIZE + (long long)(spilledCount * sizeof(MemoryEvent)));
+        return ok;
+#else
+        return pread(fileno(spillFile), &out, sizeof(MemoryEvent), (off_t)offset) == (ssize_t)sizeof(MemoryEvent);
+#endif
+    }
 
-        if (isPtr) {
-            int id = memManager.createStackVariable(name, size);
-            MemoryBlock* block = memManager.findBlock(id);
-            if (block) {
-                block->isPointer = true;
-                block->pointerType = PointerType::RAW;
-                block->pointsTo = -1;
-            }
-            variables[name] = id;
-        }
-        else {
-            int id = memManager.createStackVariable(name, size);
-            variables[name] = id;
+    // 최근 n개 이벤트를 오래된 순서로 복사 없이 순회
+    template <typename Fn>
+    void forEachRecent(size_t n, Fn&& fn) const {
+        if (n > retained) n = retained;
+        for (uint64_t i = total - n; i < total; i++) {
+            fn(ring[i & mask]);
         }
+    }
 
-        return true;
+    // 기록 비우기 (링 버퍼 용량은 유지, 디스크 기록은 새로 시작)
+    void clear() {
+        ring.clear();
+        retained = 0;
+        total = 0;
+        if (spillFile) openSpill();
     }
+};
 
-    // new 연산자 파싱 (ptr = new int;)
-    bool parseNew(const string& line) {
-        size_t equalPos = line.find('=');
-        if (equalPos == string::npos) return false;
+// ==================== 트레이스 파일 ====================
+//
+// 바이너리 트레이스 형식 (버전 2, 리틀 엔디언, 추가 기록 전용)
+//   헤더     : "MVTRACE\0", 버전, 헤더 크기, 이벤트 레코드 크기, 인덱스 주기
+//   세그먼트 : { tag, count, payload 바이트 수 } + payload
+//     STRS - 새로 등장한 이름 문자열 (u32 길이 + 바이트), 파일 전체에서 순서대로 ID 부여
+//     EVTS - 고정 길이 TraceEventRecord 배열
+//     SESS - 새 실행 세션 시작 (payload 없음): 이후 이벤트는 빈 상태에서 다시 시작하며 블록 ID도 새로 매겨짐
+//     INDX - 이전 INDX 오프셋 + 직전 구간 세그먼트들의 { 첫 이벤트 인덱스, 오프셋 }
+//     TEND - 정상 종료 표시: 마지막 INDX 오프셋, 전체 이벤트 수, 전체 문자열 수
+//   버전 1 파일은 SESS가 없는 단일 세션으로 읽음
+
+struct TraceFileHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t headerSize;
+    uint32_t recordSize;
+    uint32_t indexInterval;
+    uint64_t reserved;
+};
 
-        string varPart = trim(line.substr(0, equalPos));
-        string valuePart = trim(line.substr(equalPos + 1));
+struct TraceSegmentHeader {
+    uint32_t tag;
+    uint32_t count;
+    uint64_t payloadBytes;
+};
 
-        auto tokens = tokenize(varPart);
-        string varName;
+struct TraceIndexEntry {
+    uint64_t firstEvent;
+    uint64_t offset;
+};
 
-        for (auto it = tokens.rbegin(); it != tokens.rend(); ++it) {
-            string token = *it;
-            token.erase(remove(token.begin(), token.end(), '*'), token.end());
-            if (!token.empty() && !isBasicType(token)) {
-                varName = *it;
-                varName.erase(remove(varName.begin(), varName.end(), '*'), varName.end());
-                break;
-            }
-        }
+struct TraceEndRecord {
+    uint64_t lastIndexOffset;
+    uint64_t totalEvents;
+    uint64_t totalStrings;
+};
 
-        if (varName.empty() && !tokens.empty()) {
-            varName = tokens.back();
-            varName.erase(remove(varName.begin(), varName.end(), '*'), varName.end());
-        }
+// 상태 재구성에 필요한 정보를 모두 담은 이벤트 레코드 (32바이트)
+struct TraceEventRecord {
+    uint8_t type;
+    uint8_t detail;
+    uint8_t flags;
+    uint8_t reserved;
+    int32_t blockId;
+    int32_t targetId;
+    uint32_t nameId;
+    uint64_t size;
+    uint64_t timestamp;
+};
 
-        size_t newPos = valuePart.find("new ");
-        if (newPos == string::npos) return false;
+static_assert(sizeof(TraceEventRecord) == 32, "trace record layout changed");
 
-        string typeStr = trim(valuePart.substr(newPos + 4));
-        if (typeStr.find('(') != string::npos) typeStr = typeStr.substr(0, typeStr.find('('));
-        if (typeStr.find(';') != string::npos) typeStr = typeStr.substr(0, typeStr.find(';'));
-        typeStr = trim(typeStr);
+constexpr uint32_t TRACE_VERSION = 2;
+constexpr uint32_t TRACE_MIN_VERSION = 1;
+constexpr uint8_t TRACE_FLAG_POINTER = 1;
 
-        string heapName = varName + "_data";
-        size_t size = getTypeSize(typeStr);
-        int heapId = memManager.allocateHeap(heapName, size, PointerType::RAW);
+constexpr uint32_t traceTag(const char (&text)[5]) {
+    return (uint32_t)(uint8_t)text[0] | ((uint32_t)(uint8_t)text[1] << 8) |
+        ((uint32_t)(uint8_t)text[2] << 16) | ((uint32_t)(uint8_t)text[3] << 24);
+}
 
-        auto it = variables.find(varName);
-        if (it == variables.end()) return false;
+constexpr uint32_t TRACE_TAG_STRINGS = traceTag("STRS");
+constexpr uint32_t TRACE_TAG_EVENTS = traceTag("EVTS");
+constexpr uint32_t TRACE_TAG_SESSION = traceTag("SESS");
+constexpr uint32_t TRACE_TAG_INDEX = traceTag("INDX");
+constexpr uint32_t TRACE_TAG_END = traceTag("TEND");
 
-        memManager.assignPointer(it->second, heapId);
-        return true;
+// 이벤트를 발생 즉시 트레이스 파일로 흘려보내는 기록기
+class TraceWriter {
+private:
+    static constexpr size_t EVENTS_PER_SEGMENT = 1024;
+    static constexpr uint32_t SEGMENTS_PER_INDEX = 64;
+
+    FILE* file;
+    uint64_t offset;
+    uint64_t eventCount;
+    // 이름 ID는 세션마다 0부터 다시 매겨지므로 파일에서는 이전 세션까지의 문자열 수를 더해 씀
+    uint32_t stringBase;
+    uint32_t stringsWritten;    // 이번 세션 이름 저장소에서 기록한 문자열 수
+    uint64_t sessionFirstEvent;
+    uint64_t lastIndexOffset;
+
+    vector<TraceEventRecord> pending;
+    vector<TraceIndexEntry> segmentsSinceIndex;
+    vector<char> scratch;
+
+    void write(const void* data, size_t bytes) {
+        fwrite(data, 1, bytes, file);
+        offset += bytes;
+    }
+
+    void writeSegmentHeader(uint32_t tag, uint32_t count, uint64_t payloadBytes) {
+        TraceSegmentHeader header{ tag, count, payloadBytes };
+        write(&header, sizeof(header));
     }
 
-    // delete 연산자 파싱 (delete ptr;)
-    bool parseDelete(const string& line) {
-        string varName = trim(line.substr(7));
-        if (!varName.empty() && varName.back() == ';') varName.pop_back();
+    // 아직 파일에 없는 이름들을 STRS 세그먼트로 기록
+    void writeNewStrings(const StringArena& names) {
+        uint32_t total = (uint32_t)names.count();
+        if (stringsWritten >= total) return;
+
+        scratch.clear();
+        for (uint32_t id = stringsWritten; id < total; id++) {
+            string_view text = names.get(id);
+            uint32_t length = (uint32_t)text.size();
+            const char* lengthBytes = reinterpret_cast<const char*>(&length);
+            scratch.insert(scratch.end(), lengthBytes, lengthBytes + sizeof(length));
+            scratch.insert(scratch.end(), text.begin(), text.end());
+        }
 
-        auto it = variables.find(varName);
-        if (it == variables.end()) return false;
+        segmentsSinceIndex.push_back({ eventCount, offset });
+        writeSegmentHeader(TRACE_TAG_STRINGS, total - stringsWritten, scratch.size());
+        write(scratch.data(), scratch.size());
+        stringsWritten = total;
+    }
 
-        MemoryBlock* ptrBlock = memManager.findBlock(it->second);
-        if (!ptrBlock || !ptrBlock->isPointer) return false;
+    void writeIndex() {
+        if (segmentsSinceIndex.empty()) return;
+        uint64_t indexOffset = offset;
+        uint64_t payload = sizeof(uint64_t) + segmentsSinceIndex.size() * sizeof(TraceIndexEntry);
+        writeSegmentHeader(TRACE_TAG_INDEX, (uint32_t)segmentsSinceIndex.size(), payload);
+        write(&lastIndexOffset, sizeof(lastIndexOffset));
+        write(segmentsSinceIndex.data(), segmentsSinceIndex.size() * sizeof(TraceIndexEntry));
+        segmentsSinceIndex.clear();
+        lastIndexOffset = indexOffset;
+    }
 
-        if (ptrBlock->pointsTo != -1) {
-            memManager.deallocate(ptrBlock->pointsTo);
-            ptrBlock->pointsTo = -1;
-        }
+public:
+    TraceWriter()
+        : file(nullptr), offset(0), eventCount(0), stringBase(0), stringsWritten(0), sessionFirstEvent(0),
+        lastIndexOffset(0) {}
+    ~TraceWriter() { close(); }
+
+    TraceWriter(const TraceWriter&) = delete;
+    TraceWriter& operator=(const TraceWriter&) = delete;
+
+    bool open(const string& path) {
+        close();
+        file = fopen(path.c_str(), "wb");
+        if (!file) return false;
+
+        offset = 0;
+        eventCount = 0;
+        stringBase = 0;
+        stringsWritten = 0;
+        sessionFirstEvent = 0;
+        lastIndexOffset = 0;
+        pending.clear();
+        pending.reserve(EVENTS_PER_SEGMENT);
+        segmentsSinceIndex.clear();
+
+        TraceFileHeader header = {};
+        memcpy(header.magic, "MVTRACE", 8);
+        header.version = TRACE_VERSION;
+        header.headerSize = sizeof(TraceFileHeader);
+        header.recordSize = sizeof(TraceEventRecord);
+        header.indexInterval = SEGMENTS_PER_INDEX;
+        write(&header, sizeof(header));
         return true;
     }
 
-    // 할당 연산 파싱 (ptr = &var; 또는 ptr = nullptr;)
-    bool parseAssignment(const string& line) {
-        size_t equalPos = line.find('=');
-        if (equalPos == string::npos) return true;
+    bool isOpen() const { return file != nullptr; }
+
+    void append(const TraceEventRecord& record, const StringArena& names) {
+        pending.push_back(record);
+        pending.back().nameId += stringBase;
+        if (pending.size() >= EVENTS_PER_SEGMENT) flush(names);
+    }
 
-        string leftSide = trim(line.substr(0, equalPos));
-        string rightSide = trim(line.substr(equalPos + 1));
+    // 모아둔 이벤트를 EVTS 세그먼트로 기록
+    void flush(const StringArena& names) {
+        if (!file || pending.empty()) return;
+        writeNewStrings(names);
 
-        if (!rightSide.empty() && rightSide.back() == ';') rightSide.pop_back();
+        segmentsSinceIndex.push_back({ eventCount, offset });
+        writeSegmentHeader(TRACE_TAG_EVENTS, (uint32_t)pending.size(),
+            pending.size() * sizeof(TraceEventRecord));
+        write(pending.data(), pending.size() * sizeof(TraceEventRecord));
+        eventCount += pending.size();
+        pending.clear();
 
-        auto leftTokens = tokenize(leftSide);
-        string leftVarName = leftTokens.back();
-        leftVarName.erase(remove(leftVarName.begin(), leftVarName.end(), '*'), leftVarName.end());
+        if (segmentsSinceIndex.size() >= SEGMENTS_PER_INDEX) writeIndex();
+    }
 
-        auto leftIt = variables.find(leftVarName);
-        if (leftIt == variables.end()) return true;
+    // 지금까지의 이벤트를 파일에 반영 (종료 레코드 없이도 순차 탐색으로 읽을 수 있음)
+    void sync(const StringArena& names) {
+        if (!file) return;
+        flush(names);
+        fflush(file);
+    }
 
-        if (rightSide == "nullptr" || rightSide == "NULL") {
-            memManager.assignPointer(leftIt->second, -1);
-            return true;
-        }
+    // 관리자가 초기화될 때 호출: 지금 세션을 마무리하고 SESS 표시 뒤에 다음 세션을 이어 씀
+    // (이벤트가 없는 세션은 만들지 않음, names는 비우기 전의 이름 저장소)
+    void beginSession(const StringArena& names) {
+        if (!file) return;
+        flush(names);
+        stringBase += stringsWritten;
+        stringsWritten = 0;
+        if (eventCount == sessionFirstEvent) return;
+        sessionFirstEvent = eventCount;
+        segmentsSinceIndex.push_back({ eventCount, offset });
+        writeSegmentHeader(TRACE_TAG_SESSION, 0, 0);
+        if (segmentsSinceIndex.size() >= SEGMENTS_PER_INDEX) writeIndex();
+    }
 
-        if (rightSide.size() > 1 && rightSide[0] == '&') {
-            string targetName = trim(rightSide.substr(1));
-            targetName.erase(remove(targetName.begin(), targetName.end(), ';'), targetName.end());
+    // 남은 이벤트와 인덱스, 종료 레코드를 기록하고 닫음
+    void finish(const StringArena& names) {
+        if (!file) return;
+        flush(names);
+        writeNewStrings(names);
+        writeIndex();
+
+        TraceEndRecord end{ lastIndexOffset, eventCount, stringBase + stringsWritten };
+        writeSegmentHeader(TRACE_TAG_END, 0, sizeof(end));
+        write(&end, sizeof(end));
+        close();
+    }
 
-            auto targetIt = variables.find(targetName);
-            if (targetIt != variables.end()) {
-                memManager.assignPointer(leftIt->second, targetIt->second);
-                return true;
-            }
-        }
+    // 종료 레코드 없이 닫음 (읽을 때 세그먼트를 순차 탐색해 복구)
+    void close() {
+        if (file) fclose(file);
+        file = nullptr;
+    }
+};
 
-        string rightVarName = rightSide;
-        rightVarName.erase(remove(rightVarName.begin(), rightVarName.end(), ';'), rightVarName.end());
+// ==================== 할당자 모델 ====================
 
-        auto rightIt = variables.find(rightVarName);
-        if (rightIt != variables.end()) {
-            MemoryBlock* rightBlock = memManager.findBlock(rightIt->second);
-            if (rightBlock && rightBlock->isPointer) {
-                memManager.assignPointer(leftIt->second, rightBlock->pointsTo);
-            }
-            return true;
-        }
+// 시뮬레이션 힙 주소를 정하는 할당자 종류
+enum class AllocatorKind {
+    BUMP,       // 끝에서 계속 잘라 씀 (맨 끝 블록이나 힙 전체가 비었을 때만 되돌림)
+    SLAB,       // 크기 등급별 슬랩 + 빈 칸 비트맵, 큰 블록은 페이지 단위
+    BUDDY,      // 2의 거듭제곱 버디 (해제 시 짝과 병합)
+    FIRST_FIT   // 주소순 빈 구간 중 처음 맞는 곳 (최대 길이를 보강한 트립으로 탐색)
+};
 
-        return true;
+const char* allocatorKindName(AllocatorKind kind) {
+    switch (kind) {
+    case AllocatorKind::BUMP: return "bump";
+    case AllocatorKind::SLAB: return "slab";
+    case AllocatorKind::BUDDY: return "buddy";
+    case AllocatorKind::FIRST_FIT: return "first-fit";
     }
+    return "";
+}
 
-    // 한 줄의 코드 실행
-    bool executeLine(const string& line) {
-        string trimmedLine = trim(line);
-
-        if (trimmedLine.find("int main(") != string::npos) {
-            scopeLevel = 0;
+bool parseAllocatorKind(string_view text, AllocatorKind& kind) {
+    for (AllocatorKind candidate : { AllocatorKind::BUMP, AllocatorKind::SLAB, AllocatorKind::BUDDY, AllocatorKind::FIRST_FIT }) {
+        if (text == allocatorKindName(candidate)) {
+            kind = candidate;
             return true;
         }
+    }
+    return false;
+}
 
-        if (trimmedLine == "{") {
-            scopeLevel++;
-            return true;
-        }
+// 가장 낮은 1 비트의 위치 (value != 0)
+inline int lowestBit(uint64_t value) {
+#ifdef _MSC_VER
+    unsigned long index;
+    _BitScanForward64(&index, value);
+    return (int)index;
+#else
+    return __builtin_ctzll(value);
+#endif
+}
 
-        if (trimmedLine == "}") {
-            if (scopeLevel > 0) {
-                scopeLevel--;
-            }
-            return true;
-        }
+// 주소 -> 정수 해시 표 (열린 주소법, 선형 탐사)
+// 주소 추적의 블록 ID, 버디 할당자의 빈 블록 차수 등을 담음
+// 키와 값을 한 칸에 붙여 두어 조회가 캐시 라인 하나에서 끝나고, 삭제는 뒤따르는 항목을
+// 당겨 채우므로 묘비가 쌓이지 않음. 키 0은 빈 칸 표시 (0번지는 할당 주소가 될 수 없음)
+// 칸 배열은 CowVector라 표 복사(할당자 체크포인트)는 청크 포인터만 복사함
+class AddressMap {
+private:
+    struct Entry {
+        uint64_t key;
+        int value;
+    };
 
-        if (trimmedLine.find("delete ") == 0) return parseDelete(trimmedLine);
+    static constexpr size_t MIN_CAPACITY = 1024;
 
-        if (trimmedLine.find(" = new ") != string::npos) {
-            auto tokens = tokenize(trimmedLine);
-            if (tokens.size() >= 2 && (isBasicType(tokens[0]) || tokens[0].find('*') != string::npos)) {
-                size_t equalPos = trimmedLine.find('=');
-                string declPart = trim(trimmedLine.substr(0, equalPos));
-                if (!parseDeclaration(declPart + ";")) return false;
-                return parseNew(trimmedLine);
-            }
-            else {
-                return parseNew(trimmedLine);
-            }
+    CowVector<Entry> entries;
+    size_t mask = 0;
+    size_t count = 0;
+
+    // 1MB 구간 안에서는 16바이트 단위 주소를 그대로 이어진 칸에 두고, 구간의 시작 칸만 피보나치 해싱으로 흩음
+    // 할당자는 가까운 주소를 연달아 내주므로 이웃한 조회가 같은 캐시 라인/페이지에 모임
+    // (주소 전체를 해싱하면 살아있는 블록이 많을 때 조회마다 캐시 미스가 나서 가져오기 처리량이 절반 가까이 떨어짐)
+    size_t home(uint64_t key) const {
+        return (size_t)(((key >> 4) + (((key >> 20) * 0x9E3779B97F4A7C15ULL) >> 40)) & mask);
+    }
+
+    void rehash(size_t capacity) {
+        CowVector<Entry> old = move(entries);
+        entries = CowVector<Entry>();
+        entries.assign(capacity, Entry{ 0, -1 });
+        mask = capacity - 1;
+        count = 0;
+        for (const Entry& entry : old) {
+            if (entry.key != 0) insert(entry.key, entry.value);
         }
+    }
 
-        if (trimmedLine.find(" = ") != string::npos && trimmedLine.find(';') != string::npos) {
-            auto tokens = tokenize(trimmedLine);
-            if (tokens.size() >= 2 && (isBasicType(tokens[0]) || tokens[0].find('*') != string::npos)) {
-                size_t equalPos = trimmedLine.find('=');
-                string declPart = trim(trimmedLine.substr(0, equalPos));
+public:
+    AddressMap() { rehash(MIN_CAPACITY); }
 
-                if (!parseDeclaration(declPart + ";")) return false;
+    size_t size() const { return count; }
 
-                string varName = tokens[1];
-                if (tokens[0].find('*') != string::npos && tokens.size() == 2) {
-                }
-                else if (tokens.size() > 2) {
-                    auto declTokens = tokenize(declPart);
-                    varName = declTokens.back();
-                }
-                varName.erase(remove(varName.begin(), varName.end(), '*'), varName.end());
+    // 키의 값 (없으면 -1)
+    int find(uint64_t key) const {
+        for (size_t i = home(key);; i = (i + 1) & mask) {
+            if (entries[i].key == key) return entries[i].value;
+            if (entries[i].key == 0) return -1;
+        }
+    }
 
-                string assignCmd = varName + " = " + trim(trimmedLine.substr(equalPos + 1));
-                return parseAssignment(assignCmd);
-            }
-            return parseAssignment(trimmedLine);
+    // 새 키 추가 또는 기존 값 교체 (사용률 1/2을 넘으면 두 배로)
+    void insert(uint64_t key, int value) {
+        if ((count + 1) * 2 > entries.size()) rehash(entries.size() * 2);
+        size_t i = home(key);
+        while (entries[i].key != 0 && entries[i].key != key) i = (i + 1) & mask;
+        if (entries[i].key == 0) count++;
+        entries.set(i, Entry{ key, value });
+    }
+
+    // 키를 지우고 값 반환 (없으면 -1)
+    int erase(uint64_t key) {
+        size_t i = home(key);
+        while (entries[i].key != key) {
+            if (entries[i].key == 0) return -1;
+            i = (i + 1) & mask;
+        }
+        int value = entries[i].value;
+
+        // 빈 칸 뒤의 연속 구간에서 원래 자리가 (i, j] 밖인 항목을 빈 칸으로 당겨옴
+        for (size_t j = (i + 1) & mask; entries[j].key != 0; j = (j + 1) & mask) {
+            size_t k = home(entries[j].key);
+            bool stays = i < j ? (k > i && k <= j) : (k > i || k <= j);
+            if (stays) continue;
+            entries.set(i, entries[j]);
+            i = j;
         }
+        entries.ref(i).key = 0;
+        count--;
+        return value;
+    }
+
+    void clear() {
+        entries = CowVector<Entry>();
+        rehash(MIN_CAPACITY);
+    }
+};
 
-        if (trimmedLine.find("return ") == 0) return true;
+// 힙 주소 할당자 모델 인터페이스
+// 크기는 16바이트 단위로 올려 쓰므로 모든 주소가 16바이트 정렬됨 (HEAP_BASE도 정렬되어 있음)
+class AllocatorModel {
+protected:
+    static constexpr uint64_t HEAP_BASE = 0x10000000;
+    static constexpr uint64_t ALIGNMENT = 16;
+    // 모델 힙이 쓸 수 있는 주소 범위 (1TB, 버디 할당자의 영역 크기와 같음)
+    // 이보다 큰 요청이나 이 범위를 넘게 늘어나는 배치는 공간 없음(0)으로 처리해
+    // 크기 정렬의 넘침과 페이지 표 같은 모델 내부 상태가 터무니없이 커지는 것을 막음
+    static constexpr uint64_t MAX_EXTENT = 1ULL << 40;
+
+    // 지금까지 쓴 가장 높은 주소 끝 (HEAP_BASE 기준)
+    uint64_t highWater = 0;
+    // 살아있는 블록이 요청한 바이트 / 모델이 실제로 잡아 둔 바이트 (정렬, 등급, 버디 크기로 올린 값)
+    uint64_t requestedBytes = 0;
+    uint64_t reservedBytes = 0;
+    // 공간이 없어 주소를 주지 못한 요청 수
+    uint64_t failedAllocations = 0;
+
+    // alignSize는 MAX_EXTENT 이하의 크기로만 부름 (allocate에서 거름)
+    static uint64_t alignSize(size_t size) {
+        return size == 0 ? ALIGNMENT : ((uint64_t)size + ALIGNMENT - 1) & ~(ALIGNMENT - 1);
+    }
 
-        auto tokens = tokenize(trimmedLine);
-        if (tokens.size() >= 2) {
-            if (isBasicType(tokens[0]) || tokens[0].find('*') != string::npos) {
-                return parseDeclaration(trimmedLine);
-            }
+    void touch(uint64_t end) {
+        if (end > highWater) highWater = end;
+    }
+
+public:
+    virtual ~AllocatorModel() = default;
+
+    // 모델별 구현 (allocate/release를 통해 호출)
+    // place: size 바이트 블록의 주소 (공간이 없으면 0), reclaim: place가 돌려준 주소를 같은 크기로 해제
+    virtual uint64_t place(size_t size) = 0;
+    virtual void reclaim(uint64_t address, size_t size) = 0;
+    // size 바이트 요청에 실제로 잡히는 바이트
+    virtual uint64_t reservedSize(size_t size) const = 0;
+    // 현재 힙 끝 (줄어들 수 없는 모델은 최대값)
+    virtual uint64_t currentExtent() const { return highWater; }
+    // 체크포인트용 복제 (모델 상태는 CowVector 열에 두므로 청크 포인터만 복사되고,
+    // 이후 쓰기에서 건드린 청크만 복제됨)
+    virtual unique_ptr<AllocatorModel> clone() const = 0;
+    // 빈 힙으로 되돌림 (열의 청크는 남겨 두어 다음 실행에서 다시 할당하지 않음)
+    virtual void clear() = 0;
+
+    // size 바이트 블록의 주소, 공간이 없으면 0 (실패 횟수에 셈)
+    uint64_t allocate(size_t size) {
+        uint64_t address = (uint64_t)size <= MAX_EXTENT ? place(size) : 0;
+        if (address == 0) {
+            failedAllocations++;
+            return 0;
         }
+        requestedBytes += size;
+        reservedBytes += reservedSize(size);
+        return address;
+    }
 
-        return true;
+    void release(uint64_t address, size_t size) {
+        reclaim(address, size);
+        requestedBytes -= size;
+        reservedBytes -= reservedSize(size);
+    }
+
+    // 힙이 차지했던 최대 주소 범위 (바이트, 단편화 비교용)
+    uint64_t getFootprint() const { return highWater; }
+    uint64_t getRequestedBytes() const { return requestedBytes; }
+    uint64_t getReservedBytes() const { return reservedBytes; }
+    uint64_t getFailedAllocations() const { return failedAllocations; }
+
+protected:
+    void clearCounters() {
+        highWater = 0;
+        requestedBytes = 0;
+        reservedBytes = 0;
+        failedAllocations = 0;
     }
+};
+
+// 범프 할당자: 해제된 공간은 맨 끝 블록일 때만, 또는 모든 블록이 해제되면 한꺼번에 되돌림
+class BumpAllocator : public AllocatorModel {
+private:
+    uint64_t top = 0;
+    size_t liveCount = 0;
 
 public:
-    ScriptParser(MemoryManager& manager)
-        : memManager(manager), scopeLevel(0) {
+    uint64_t place(size_t size) override {
+        uint64_t offset = top;
+        if (alignSize(size) > MAX_EXTENT - top) return 0;
+        top += alignSize(size);
+        touch(top);
+        liveCount++;
+        return HEAP_BASE + offset;
     }
 
-    // 스크립트를 한 줄씩 단계별로 실행
-    bool executeScriptStepByStep(const string& script,
-        function<void(const string&, int)> stepCallback) {
-        auto lines = splitIntoLines(script);
-        int lineNumber = 0;
+    void reclaim(uint64_t address, size_t size) override {
+        uint64_t offset = address - HEAP_BASE;
+        if (--liveCount == 0) top = 0;
+        else if (offset + alignSize(size) == top) top = offset;
+    }
 
-        for (const auto& line : lines) {
-            lineNumber++;
-            string cleaned = removeComments(line);
-            string trimmedLine = trim(cleaned);
+    uint64_t reservedSize(size_t size) const override { return alignSize(size); }
+    uint64_t currentExtent() const override { return top; }
 
-            if (trimmedLine.empty()) continue;
+    unique_ptr<AllocatorModel> clone() const override { return make_unique<BumpAllocator>(*this); }
 
-            if (stepCallback) {
-                stepCallback(line, lineNumber);
-            }
+    void clear() override {
+        clearCounters();
+        top = 0;
+        liveCount = 0;
+    }
+};
 
-            if (!executeLine(trimmedLine)) {
-                return false;
-            }
-        }
+// 크기 등급별 슬랩 할당자
+// 작은 블록은 등급 크기로 올려 4KB 슬랩에 담고, 슬랩마다 빈 칸 비트맵(1: 빈 칸)을 둬서
+// 가장 낮은 빈 칸을 비트 연산 한 번으로 찾음. 큰 블록은 페이지 단위로 잘라 같은 페이지 수끼리 재사용
+class SlabAllocator : public AllocatorModel {
+private:
+    static constexpr uint64_t PAGE_SIZE = 4096;
+    static constexpr uint64_t MAX_SMALL = 1024;
+    // 16..128은 16 간격, 그 위는 2의 거듭제곱 구간을 4등분 (160, 192, ..., 1024)
+    static constexpr int CLASS_COUNT = 20;
+
+    struct Slab {
+        uint64_t offset;
+        uint32_t objectSize;
+        uint16_t capacity;
+        uint16_t used;
+        uint64_t freeBits[PAGE_SIZE / ALIGNMENT / 64];
+        // 빈 칸이 있는 슬랩 목록에 들어 있는지
+        bool listed;
+    };
 
-        if (stepCallback) {
-            stepCallback("// 프로그램 종료 - 스택 메모리 정리 중...", lineNumber + 1);
+    CowVector<Slab> slabs;
+    // 등급별 빈 칸이 있는 슬랩
+    CowVector<int> partial[CLASS_COUNT];
+    // 슬랩 페이지 주소 -> 슬랩 번호 (큰 블록 페이지는 없음)
+    // 표로 두면 큰 블록이 차지한 주소 범위만큼 자라므로 슬랩 수에만 비례하는 해시 표를 씀
+    AddressMap pageOwner;
+    // 페이지 수 -> 해제된 큰 블록 오프셋
+    unordered_map<uint64_t, CowVector<uint64_t>> freeRuns;
+    uint64_t nextPage = 0;
+
+    static int sizeClass(uint64_t size) {
+        if (size <= 128) return (int)((size - 1) / 16);
+        int index = 8;
+        uint64_t power = 128;
+        while (power * 2 < size) {
+            power *= 2;
+            index += 4;
         }
+        return index + (int)((size - power - 1) / (power / 4));
+    }
 
-        memManager.clearAllStack();
+    static uint64_t classSize(int index) {
+        if (index < 8) return (uint64_t)(index + 1) * 16;
+        uint64_t power = (uint64_t)128 << ((index - 8) / 4);
+        return power + power / 4 * ((index - 8) % 4 + 1);
+    }
 
+    // 새 페이지의 오프셋 (범위를 넘으면 false)
+    bool takePages(uint64_t count, uint64_t& offset) {
+        if (count > (MAX_EXTENT - nextPage) / PAGE_SIZE) return false;
+        offset = nextPage;
+        nextPage += count * PAGE_SIZE;
+        touch(nextPage);
         return true;
     }
 
-    // 파서 초기화
-    void reset() {
-        variables.clear();
-        scopeLevel = 0;
+    // 새 슬랩 번호 (페이지가 없으면 -1)
+    int newSlab(int index) {
+        Slab slab{};
+        if (!takePages(1, slab.offset)) return -1;
+        slab.objectSize = (uint32_t)classSize(index);
+        slab.capacity = (uint16_t)(PAGE_SIZE / slab.objectSize);
+        for (uint32_t i = 0; i < slab.capacity; i++) slab.freeBits[i / 64] |= 1ULL << (i % 64);
+        slab.listed = true;
+        int id = (int)slabs.size();
+        slabs.push_back(slab);
+        pageOwner.insert(HEAP_BASE + slab.offset, id);
+        partial[index].push_back(id);
+        return id;
     }
 
-    // 예제 스크립트 가져오기
-    static string getExampleScript(int index) {
-        switch (index) {
-        case 0:
-            return
-                "// 예제 1: 동적할당 - 메모리 누수\n"
-                "int main() {\n"
-                "    int* ptr = new int;\n"
-                "    return 0;\n"
-                "}";
-
-        case 1:
-            return
-                "// 예제 2: 동적할당 - delete 사용\n"
-                "int main() {\n"
-                "    int* ptr = new int;\n"
-                "    delete ptr;\n"
-                "    return 0;\n"
-                "}";
-
-        case 2:
-            return
-                "// 예제 3: Stack vs Heap\n"
-                "int main() {\n"
-                "    int stackVar = 5;\n"
-                "    int* heapPtr = new int;\n"
-                "    delete heapPtr;\n"
-                "    return 0;\n"
-                "}";
+public:
+    uint64_t place(size_t size) override {
+        uint64_t aligned = alignSize(size);
+        if (aligned > MAX_SMALL) {
+            uint64_t pages = (aligned + PAGE_SIZE - 1) / PAGE_SIZE;
+            auto it = freeRuns.find(pages);
+            if (it != freeRuns.end() && !it->second.empty()) {
+                uint64_t offset = it->second.back();
+                it->second.pop_back();
+                return HEAP_BASE + offset;
+            }
+            uint64_t offset;
+            return takePages(pages, offset) ? HEAP_BASE + offset : 0;
+        }
 
-        case 3:
-            return
-                "// 예제 4: 다중 포인터 (Double Pointer)\n"
-                "int main() {\n"
-                "    int* ptr = new int;\n"
-                "    int** dptr = &ptr;\n"
-                "    delete ptr;\n"
-                "    return 0;\n"
-                "}";
+        int index = sizeClass(aligned);
+        CowVector<int>& list = partial[index];
+        int id = list.empty() ? newSlab(index) : list.back();
+        if (id == -1) return 0;
+        Slab& slab = slabs.ref(id);
+        int word = 0;
+        while (slab.freeBits[word] == 0) word++;
+        int bit = lowestBit(slab.freeBits[word]);
+        slab.freeBits[word] &= ~(1ULL << bit);
+        if (++slab.used == slab.capacity) {
+            list.pop_back();
+            slab.listed = false;
+        }
+        return HEAP_BASE + slab.offset + (uint64_t)(word * 64 + bit) * slab.objectSize;
+    }
 
-        case 4:
-            return
-                "// 예제 5: 포인터 배열\n"
-                "int main() {\n"
-                "    int* arr1 = new int;\n"
-                "    int* arr2 = new int;\n"
-                "    int* arr3 = new int;\n"
-                "    delete arr3;\n"
-                "    delete arr2;\n"
-                "    delete arr1;\n"
-                "    return 0;\n"
-                "}";
+    void reclaim(uint64_t address, size_t size) override {
+        uint64_t offset = address - HEAP_BASE;
+        uint64_t aligned = alignSize(size);
+        if (aligned > MAX_SMALL) {
+            freeRuns[(aligned + PAGE_SIZE - 1) / PAGE_SIZE].push_back(offset);
+            return;
+        }
 
-        default:
-            return "";
+        int id = pageOwner.find(HEAP_BASE + offset / PAGE_SIZE * PAGE_SIZE);
+        Slab& slab = slabs.ref(id);
+        uint64_t slot = (offset - slab.offset) / slab.objectSize;
+        slab.freeBits[slot / 64] |= 1ULL << (slot % 64);
+        slab.used--;
+        if (!slab.listed) {
+            partial[sizeClass(slab.objectSize)].push_back(id);
+            slab.listed = true;
         }
     }
 
-    static int getExampleCount() {
-        return 5;
+    uint64_t reservedSize(size_t size) const override {
+        uint64_t aligned = alignSize(size);
+        if (aligned > MAX_SMALL) return (aligned + PAGE_SIZE - 1) / PAGE_SIZE * PAGE_SIZE;
+        return classSize(sizeClass(aligned));
+    }
+
+    unique_ptr<AllocatorModel> clone() const override { return make_unique<SlabAllocator>(*this); }
+
+    void clear() override {
+        clearCounters();
+        slabs.clear();
+        for (CowVector<int>& list : partial) list.clear();
+        pageOwner.clear();
+        freeRuns.clear();
+        nextPage = 0;
     }
 };
 
-// ==================== 메인 함수 ====================
+// 버디 할당자: 2^MAX_ORDER 바이트 영역 하나를 반씩 나눠 쓰고, 해제 시 짝(오프셋 ^ 크기)이 비어 있으면 병합
+// 차수별 빈 목록은 지연 삭제 스택이고, 실제로 비어 있는지는 freeOrder(주소 -> 차수)가 기준
+class BuddyAllocator : public AllocatorModel {
+private:
+    static constexpr int MIN_ORDER = 4;    // 16바이트
+    static constexpr int MAX_ORDER = 40;
 
-// 메인 메뉴 출력
-void displayMenu() {
-    cout << "\n+-- 메뉴 ---------------------------+" << endl;
-    cout << "| 1. 예제 스크립트 단계별 실행      |" << endl;
-    cout << "| 2. 직접 코드 단계별 실행          |" << endl;
-    cout << "| 0. 종료                           |" << endl;
-    cout << "+-----------------------------------+" << endl;
-    cout << "선택: ";
-}
+    CowVector<uint64_t> freeLists[MAX_ORDER + 1];
+    AddressMap freeOrder;
 
-// 예제 목록 출력
-void displayExamples() {
-    cout << "\n예제 스크립트:" << endl;
-    for (int i = 0; i < ScriptParser::getExampleCount(); i++) {
-        cout << "  " << (i + 1) << ". ";
-        string script = ScriptParser::getExampleScript(i);
-        size_t newline = script.find('\n');
-        if (newline != string::npos) {
-            cout << script.substr(3, newline - 3);
+    static int orderFor(uint64_t size) {
+        int order = MIN_ORDER;
+        while (order <= MAX_ORDER && (1ULL << order) < size) order++;
+        return order;
+    }
+
+    void pushFree(int order, uint64_t offset) {
+        freeLists[order].push_back(offset);
+        freeOrder.insert(HEAP_BASE + offset, order);
+    }
+
+    // 이 차수의 빈 블록 하나를 꺼냄 (병합으로 이미 사라진 항목은 건너뜀)
+    bool popFree(int order, uint64_t& offset) {
+        CowVector<uint64_t>& list = freeLists[order];
+        while (!list.empty()) {
+            offset = list.back();
+            list.pop_back();
+            if (freeOrder.find(HEAP_BASE + offset) == order) {
+                freeOrder.erase(HEAP_BASE + offset);
+                return true;
+            }
         }
-        cout << endl;
+        return false;
     }
-    cout << "  0. 돌아가기" << endl;
-    cout << "선택: ";
-}
 
+public:
+    BuddyAllocator() { pushFree(MAX_ORDER, 0); }
+
+    uint64_t place(size_t size) override {
+        int order = orderFor(size);
+        int found = order;
+        uint64_t offset = 0;
+        while (found <= MAX_ORDER && !popFree(found, offset)) found++;
+        if (found > MAX_ORDER) return 0;
+
+        while (found > order) {
+            found--;
+            pushFree(found, offset + (1ULL << found));
+        }
+        touch(offset + (1ULL << order));
+        return HEAP_BASE + offset;
+    }
 
-// 예제 스크립트를 단계별로 실행
-void runExampleStepByStep(int index, MemoryManager& memManager, ScriptParser& parser, Visualizer& visualizer) {
-    parser.reset();
-    memManager.reset();
+    void reclaim(uint64_t address, size_t size) override {
+        uint64_t offset = address - HEAP_BASE;
+        int order = orderFor(size);
+        while (order < MAX_ORDER) {
+            uint64_t buddy = offset ^ (1ULL << order);
+            if (freeOrder.find(HEAP_BASE + buddy) != order) break;
+            freeOrder.erase(HEAP_BASE + buddy);
+            offset = min(offset, buddy);
+            order++;
+        }
+        pushFree(order, offset);
+    }
 
-    string script = ScriptParser::getExampleScript(index);
+    uint64_t reservedSize(size_t size) const override { return 1ULL << orderFor(size); }
 
-    cout << "\n" << "=== 스크립트 (단계별 실행) ===" << endl;
-    cout << script << endl;
-    cout << "===============================" << endl;
+    unique_ptr<AllocatorModel> clone() const override { return make_unique<BuddyAllocator>(*this); }
 
-    cout << "\n 단계별 실행 모드" << endl;
-    cout << "각 줄이 실행될 때마다 메모리 변화를 확인할 수 있습니다." << endl;
-    cout << "\n아무 키나 누르면 시작합니다...";
-    cin.ignore(numeric_limits<streamsize>::max(), '\n');
-    cin.get();
+    void clear() override {
+        clearCounters();
+        for (CowVector<uint64_t>& list : freeLists) list.clear();
+        freeOrder.clear();
+        pushFree(MAX_ORDER, 0);
+    }
+};
 
-    bool result = parser.executeScriptStepByStep(script,
-        [&memManager, &visualizer](const string& line, int lineNum) {
-            visualizer.printMemoryStateWithLine(memManager, line, lineNum);
-            cin.get();
-        });
+// 최초 적합 할당자: 빈 구간을 시작 주소 순 트립에 두고, 노드마다 서브트리의 최대 길이를 보강해
+// "길이가 충분한 가장 낮은 주소 구간"을 O(log n)에 찾음. 해제 시 앞뒤 구간과 병합하고,
+// 힙 끝에 닿은 구간은 힙을 줄임 (맞는 구간이 없으면 힙 끝에서 늘림)
+// 구간을 앞에서 잘라 쓰거나 이웃과 합칠 때는 순서가 바뀌지 않으므로 노드를 제자리에서 고치고
+// 내려온 경로의 최대 길이만 다시 계산함
+class FirstFitAllocator : public AllocatorModel {
+private:
+    struct Node {
+        uint64_t start;
+        uint64_t length;
+        uint64_t maxLength;
+        uint32_t priority;
+        int left;
+        int right;
+    };
 
-    if (!result) {
-        cout << "\n[ERROR] 스크립트 실행 실패!" << endl;
-        cout << "\n아무 키나 누르면 계속...";
-        cin.get();
+    CowVector<Node> nodes;
+    CowVector<int> freeNodes;
+    // 마지막 탐색에서 루트부터 지나온 노드 (제자리 수정 후 최대 길이 갱신용)
+    vector<int> path;
+    int root = -1;
+    uint64_t heapEnd = 0;
+    uint32_t seed = 2463534242u;
+
+    uint32_t nextPriority() {
+        seed ^= seed << 13;
+        seed ^= seed >> 17;
+        seed ^= seed << 5;
+        return seed;
     }
-    else {
-        visualizer.clearScreen();
-        cout << "\n" << "프로그램 실행 완료!" << endl;
-        cout << "\n최종 메모리 상태:" << endl << endl;
 
-        auto leaks = memManager.detectLeaks();
-        if (!leaks.empty()) {
-            cout << "\033[1;31m";
-            cout << "!! 메모리 누수 감지 !! " << leaks.size() << "개 블록" << "\033[0m" << endl;
-            for (int id : leaks) {
-                const MemoryBlock* block = memManager.findBlock(id);
-                if (block) {
-                    cout << "  - \033[31m" << block->name << " (" << block->size << " bytes)\033[0m" << endl;
-                }
-            }
-            cout << endl;
+    uint64_t maxOf(int node) const { return node == -1 ? 0 : nodes[node].maxLength; }
+
+    // n은 nodes.ref()로 얻은 쓰기용 참조
+    void update(Node& n) {
+        n.maxLength = max(n.length, max(maxOf(n.left), maxOf(n.right)));
+    }
+
+    // start < key인 트리와 나머지로 나눔
+    // 내려가는 노드는 어차피 다시 계산하므로 처음부터 쓰기용 참조로 잡음 (한 번 복제한 청크는 그대로 유지됨)
+    void split(int node, uint64_t key, int& left, int& right) {
+        if (node == -1) {
+            left = right = -1;
+            return;
+        }
+        Node& n = nodes.ref(node);
+        if (n.start < key) {
+            split(n.right, key, n.right, right);
+            left = node;
         }
         else {
-            cout << "\033[32m[OK] 메모리 누수가 없습니다!\033[0m" << endl << endl;
+            split(n.left, key, left, n.left);
+            right = node;
         }
+        update(n);
+    }
 
-        visualizer.printMemoryState(memManager);
+    int merge(int left, int right) {
+        if (left == -1) return right;
+        if (right == -1) return left;
+        Node& l = nodes.ref(left);
+        Node& r = nodes.ref(right);
+        if (l.priority > r.priority) {
+            l.right = merge(l.right, right);
+            update(l);
+            return left;
+        }
+        r.left = merge(left, r.left);
+        update(r);
+        return right;
+    }
 
-        cout << "\n아무 키나 누르면 계속...";
+    void insertRange(uint64_t start, uint64_t length) {
+        Node node{ start, length, length, nextPriority(), -1, -1 };
+        int id;
+        if (!freeNodes.empty()) {
+            id = freeNodes.back();
+            freeNodes.pop_back();
+            nodes.set(id, node);
+        }
+        else {
+            id = (int)nodes.size();
+            nodes.push_back(node);
+        }
+        int left, right;
+        split(root, start, left, right);
+        root = merge(merge(left, id), right);
+    }
+
+    void eraseRange(uint64_t start) {
+        int left, middle, right;
+        split(root, start, left, middle);
+        split(middle, start + 1, middle, right);
+        if (middle != -1) freeNodes.push_back(middle);
+        root = merge(left, right);
+    }
+
+    // 길이가 size 이상인 가장 낮은 주소의 구간 (없으면 -1), 지나온 노드는 path에
+    int findFirstFit(uint64_t size) {
+        path.clear();
+        int node = root;
+        while (node != -1 && nodes[node].maxLength >= size) {
+            path.push_back(node);
+            if (maxOf(nodes[node].left) >= size) node = nodes[node].left;
+            else if (nodes[node].length >= size) return node;
+            else node = nodes[node].right;
+        }
+        return -1;
+    }
+
+    // start == key인 구간 (없으면 -1), 지나온 노드는 path에
+    int locate(uint64_t key) {
+        path.clear();
+        int node = root;
+        while (node != -1) {
+            path.push_back(node);
+            if (nodes[node].start == key) return node;
+            node = key < nodes[node].start ? nodes[node].left : nodes[node].right;
+        }
+        return -1;
+    }
+
+    // path의 노드를 아래부터 다시 계산
+    void refreshPath() {
+        for (size_t i = path.size(); i-- > 0;) update(nodes.ref(path[i]));
+    }
+
+public:
+    uint64_t place(size_t size) override {
+        uint64_t aligned = alignSize(size);
+        int node = findFirstFit(aligned);
+        if (node == -1) {
+            if (aligned > MAX_EXTENT - heapEnd) return 0;
+            uint64_t offset = heapEnd;
+            heapEnd += aligned;
+            touch(heapEnd);
+            return HEAP_BASE + offset;
+        }
+
+        uint64_t start = nodes[node].start;
+        if (nodes[node].length == aligned) {
+            eraseRange(start);
+        }
+        else {
+            Node& range = nodes.ref(node);
+            range.start += aligned;
+            range.length -= aligned;
+            refreshPath();
+        }
+        return HEAP_BASE + start;
+    }
+
+    void reclaim(uint64_t address, size_t size) override {
+        uint64_t start = address - HEAP_BASE;
+        uint64_t end = start + alignSize(size);
+
+        // 바로 앞 구간과 바로 뒤 구간은 둘 다 start를 찾아 내려가는 경로 위에 있음
+        path.clear();
+        int before = -1;
+        int after = -1;
+        size_t beforeDepth = 0;
+        size_t afterDepth = 0;
+        for (int node = root; node != -1;) {
+            path.push_back(node);
+            if (nodes[node].start < start) {
+                before = node;
+                beforeDepth = path.size();
+                node = nodes[node].right;
+            }
+            else {
+                after = node;
+                afterDepth = path.size();
+                node = nodes[node].left;
+            }
+        }
+        bool joinBefore = before != -1 && nodes[before].start + nodes[before].length == start;
+        bool joinAfter = after != -1 && nodes[after].start == end;
+        uint64_t beforeStart = joinBefore ? nodes[before].start : start;
+        uint64_t afterEnd = joinAfter ? end + nodes[after].length : end;
+
+        // 빈 구간은 힙 끝에 닿지 않으므로 이 경우 뒤쪽 구간은 없음
+        if (afterEnd == heapEnd) {
+            if (joinBefore) eraseRange(beforeStart);
+            heapEnd = beforeStart;
+            return;
+        }
+        if (!joinBefore && !joinAfter) {
+            insertRange(start, end - start);
+            return;
+        }
+
+        // 합친 구간은 남는 노드 하나를 제자리에서 넓힘
+        int node;
+        if (joinBefore && joinAfter) {
+            eraseRange(end);
+            node = locate(beforeStart);
+        }
+        else {
+            node = joinBefore ? before : after;
+            path.resize(joinBefore ? beforeDepth : afterDepth);
+        }
+        Node& range = nodes.ref(node);
+        range.start = beforeStart;
+        range.length = afterEnd - beforeStart;
+        refreshPath();
+    }
+
+    uint64_t reservedSize(size_t size) const override { return alignSize(size); }
+    uint64_t currentExtent() const override { return heapEnd; }
+
+    unique_ptr<AllocatorModel> clone() const override { return make_unique<FirstFitAllocator>(*this); }
+
+    void clear() override {
+        clearCounters();
+        nodes.clear();
+        freeNodes.clear();
+        root = -1;
+        heapEnd = 0;
+        seed = 2463534242u;
+    }
+};
+
+unique_ptr<AllocatorModel> makeAllocatorModel(AllocatorKind kind) {
+    switch (kind) {
+    case AllocatorKind::BUMP: return make_unique<BumpAllocator>();
+    case AllocatorKind::SLAB: return make_unique<SlabAllocator>();
+    case AllocatorKind::BUDDY: return make_unique<BuddyAllocator>();
+    case AllocatorKind::FIRST_FIT: break;
+    }
+    return make_unique<FirstFitAllocator>();
+}
+
+// ==================== 메모리 관리자 ====================
+
+// 메모리 통계 (할당/해제마다 O(1)로 갱신, 체크포인트에 그대로 복사됨)
+struct MemoryStats {
+    // 힙 블록 크기 등급: 16, 32, ..., 16384 이하와 그 초과
+    static constexpr int SIZE_CLASS_COUNT = 12;
+
+    uint64_t stackBytes = 0;
+    uint64_t stackBlocks = 0;
+    uint64_t heapBytes = 0;
+    uint64_t heapBlocks = 0;
+    uint64_t peakStackBytes = 0;
+    uint64_t peakStackBlocks = 0;
+    uint64_t peakHeapBytes = 0;
+    uint64_t peakHeapBlocks = 0;
+    // 크기 등급별 살아있는 힙 블록 수 / 누적 힙 할당 수
+    uint64_t liveBySize[SIZE_CLASS_COUNT] = {};
+    uint64_t allocatedBySize[SIZE_CLASS_COUNT] = {};
+
+    // 할당자 모델 힙 (MemoryManager::getStats에서 채움)
+    // simulatedHeap: 모델이 주소를 정한 블록이 있었는지 (실제 주소만 쓰는 추적/가져오기는 false라 단편화를 알 수 없음)
+    bool simulatedHeap = false;
+    uint64_t heapExtent = 0;
+    uint64_t heapReserved = 0;
+    uint64_t heapRequested = 0;
+
+    static int sizeClass(uint64_t size) {
+        int index = 0;
+        while (index < SIZE_CLASS_COUNT - 1 && sizeClassLimit(index) < size) index++;
+        return index;
+    }
+
+    // 등급의 상한 (마지막 등급은 하한 - 1)
+    static uint64_t sizeClassLimit(int index) { return 16ULL << index; }
+
+    // 외부 단편화: 모델 힙 범위 중 살아있는 블록이 잡지 않은 빈 공간의 비율
+    double externalFragmentation() const {
+        return heapExtent == 0 ? 0 : (double)(heapExtent - min(heapReserved, heapExtent)) / heapExtent;
+    }
+
+    // 내부 단편화: 잡아 둔 공간 중 요청 크기를 넘는 부분(정렬, 등급 올림)의 비율
+    double internalFragmentation() const {
+        return heapReserved == 0 ? 0 : (double)(heapReserved - heapRequested) / heapReserved;
+    }
+};
+
+class MemoryManager {
+private:
+    BlockStore blocks;
+    EventHistory events;
+    int nextId;
+    // 스택/힙 합계의 최댓값 (각 영역의 현재값과 최댓값은 stats)
+    uint64_t peakBytes;
+    MemoryStats stats;
+    // 지금까지 만든 블록 수 (재사용한 slot에 만든 블록도 셈)
+    uint64_t createdBlocks = 0;
+    uint64_t logicalClock;
+
+    // ID -> blocks 인덱스 (nextId로 발급된 조밀한 ID용)
+    CowVector<int> idToSlot;
+    // 조밀한 범위를 벗어난 외부 ID용 보조 인덱스
+    unordered_map<int, int> externalIdToSlot;
+
+    static constexpr int DENSE_ID_SLACK = 1 << 16;
+
+    // 역참조 인덱스: 대상 slot을 가리키는 살아있는 포인터들의 이중 연결 리스트 (slot 단위)
+    // 포인터는 한 번에 하나의 대상만 가리키므로 next/prev는 포인터 slot당 하나면 충분함
+    CowVector<int> firstReferrer;
+    CowVector<int> nextReferrer;
+    CowVector<int> prevReferrer;
+    CowVector<int> linkedTarget;
+
+    // 현재 연결된 포인터 slot의 이중 연결 리스트 (연결 순서, 포인터 연결 출력용)
+    // 끊을 때 순서를 유지한 채 O(1)로 빼므로 출력은 정렬 없이 리스트를 따라가기만 하면 됨
+    CowVector<int> nextEdge;
+    CowVector<int> prevEdge;
+    int firstEdge = -1;
+    int lastEdge = -1;
+
+    // 증분 누수 추적: 힙 블록별 들어오는 포인터 수와 현재 누수 블록 ID 집합
+    CowVector<int> incomingCount;
+    CowVector<int> leaks;
+    CowVector<int> leakPos;
+    // 이번 연산 중 도달 불가능해진 블록 (연산 이벤트 뒤에 LEAK 이벤트로 기록)
+    vector<int> pendingLeakEvents;
+
+    // 블록별 기록 사슬의 머리 (slot 단위): 블록의 마지막 이벤트, 블록을 가리킨 마지막 ASSIGN의 전체 인덱스
+    // 이어지는 이벤트는 각 이벤트의 prevOfBlock/prevOfTarget으로 거슬러 올라감
+    CowVector<uint64_t> lastEventOf;
+    CowVector<uint64_t> lastAssignTo;
+
+    // 도달성 분석 모드: 상태가 바뀐 경우에만 다시 계산
+    // (getLeaks()가 const로 채우는 캐시: stateVersion이 같으면 몇 번 불러도 같은 결과인 순수 계산이고,
+    // 같은 관리자를 여러 스레드에서 동시에 읽지 않으므로 mutable로 둠)
+    LeakMode leakMode;
+    unsigned long long stateVersion;
+    mutable unsigned long long reachableVersion;
+    mutable CowVector<int> unreachableLeaks;
+    mutable vector<unsigned long long> markBits;
+    // REACHABILITY 모드의 LEAK 이벤트용: 마지막 연산 뒤 스택에서 도달할 수 있던 slot 비트셋
+    // 연산 중 포인터 연결이 바뀌었으면 다시 표시해서, 도달 가능 -> 불가능으로 바뀐 힙 블록만 기록함
+    vector<unsigned long long> reachableMarks;
+    bool linksChanged = false;
+
+    // 이벤트를 실시간으로 기록하는 트레이스 파일 (없으면 nullptr)
+    unique_ptr<TraceWriter> trace;
+    // 체크포인트 복원 후 이미 기록한 구간을 다시 실행하는 동안은 트레이스에 쓰지 않음
+    bool traceSuspended = false;
+
+    // 해제된 힙 블록의 slot을 새 힙 할당에 재사용 (실제 프로그램/외부 트레이스/반복문처럼
+    // 할당이 매우 많을 때 저장소가 살아있는 블록 수에 비례하도록). 재사용되는 slot은
+    // 해제 시 모든 연결이 끊긴 상태라 블록 열만 다시 채우면 되고, ID는 새로 발급함
+    // 스택 변수는 스코프 종료로 해제될 때 가리키는 포인터가 없는 경우에만 재사용
+    bool reuseFreedBlocks = false;
+    vector<int> freeHeapSlots;
+    vector<int> freeStackSlots;
+
+    // 힙 주소를 정하는 할당자 모델
+    AllocatorKind allocatorKind = AllocatorKind::FIRST_FIT;
+    unique_ptr<AllocatorModel> allocator;
+
+    // 스택 프레임: 스코프에 들어갈 때 스택 포인터와 지역 변수 목록 길이를 표시해 두고,
+    // 나갈 때 그 뒤에 선언된 변수만 해제한 뒤 스택 포인터를 한 번에 되돌림
+    struct StackFrame {
+        uint64_t savedTop;
+        int firstLocal;     // stackLocals에서 이 프레임이 시작하는 위치
+    };
+
+    static constexpr uint64_t STACK_BASE = 0x7fff0000;
+    static constexpr uint64_t STACK_ALIGNMENT = 16;
+
+    // 스택은 아래로 자라며, 살아있는 스택 변수 slot을 선언 순서대로 보관
+    uint64_t stackTop = STACK_BASE;
+    CowVector<int> stackLocals;
+    CowVector<StackFrame> stackFrames;
+
+    // 스택 변수 주소: 크기에 맞는 2의 거듭제곱(최대 16) 경계로 내려 정렬 (그 사이는 패딩)
+    uint64_t pushStackAddress(size_t size) {
+        uint64_t align = 1;
+        while (align < size && align < STACK_ALIGNMENT) align <<= 1;
+        stackTop = (stackTop - size) & ~(align - 1);
+        return stackTop;
+    }
+
+    // stackLocals[first..]를 나중에 선언된 것부터 해제 (이미 해제된 변수는 건너뜀)
+    void releaseLocalsFrom(int first, MemoryEvent::Detail detail) {
+        while ((int)stackLocals.size() > first) {
+            int slot = stackLocals.back();
+            stackLocals.pop_back();
+            if (!blocks.allocated[slot]) continue;
+            releaseStackSlot(slot, detail);
+            if (reuseFreedBlocks && firstReferrer[slot] == -1) freeStackSlots.push_back(slot);
+        }
+    }
+
+    void releaseStackSlot(int slot, MemoryEvent::Detail detail) {
+        unlinkReferrer(slot);
+        blocks.allocated.set(slot, false);
+        countReleased(MemoryType::STACK, blocks.size[slot]);
+        int dangling = 0;
+        for (int ptrSlot = firstReferrer[slot]; ptrSlot != -1; ptrSlot = nextReferrer[ptrSlot]) dangling++;
+        addEvent(MemoryEvent::EventType::DEALLOCATE, detail, slot, -1, dangling);
+        flushLeakEvents();
+    }
+
+    // 힙 블록 생성 (simulated: 주소가 할당자 모델에서 온 것)
+    // 새 블록은 가리키는 포인터가 없으므로 바로 누수 집합에 들어가지만 LEAK 이벤트는 남기지 않음
+    // (LEAK은 포인터를 잃는 전이에만 기록. 스크립트는 곧이어 포인터를 연결하고, 포인터 정보가 없는
+    // 외부 트레이스는 끝까지 해제되지 않은 블록을 종료 시 getLeaks()/요약의 leaks로만 보고함)
+    int allocateHeapAt(string_view name, size_t size, void* address, PointerType ptrType, bool simulated) {
+        MEMVIZ_PROFILE_SCOPE("MemoryManager::allocateHeap");
+        if (!freeHeapSlots.empty()) {
+            int slot = freeHeapSlots.back();
+            freeHeapSlots.pop_back();
+            blocks.allocated.set(slot, true);
+            blocks.size.set(slot, size);
+            blocks.cold.set(slot, BlockColdData{ blocks.names.intern(name), address, 0, ptrType, 0, 0, 0, 0, false, simulated });
+            int id = reissueId(slot);
+            countAllocated(MemoryType::HEAP, size);
+            addLeak(slot);
+            addEvent(MemoryEvent::EventType::ALLOCATE, MemoryEvent::Detail::HEAP_ALLOCATE, slot);
+            return id;
+        }
+
+        BlockRecord block;
+        block.id = issueId();
+        block.name = name;
+        block.size = size;
+        block.type = MemoryType::HEAP;
+        block.address = address;
+        block.isAllocated = true;
+        block.isPointer = false;
+        block.pointerType = ptrType;
+        block.simulatedAddress = simulated;
+        int slot = insertBlock(block);
+
+        addEvent(MemoryEvent::EventType::ALLOCATE, MemoryEvent::Detail::HEAP_ALLOCATE, slot);
+
+        return block.id;
+    }
+
+    void addEvent(MemoryEvent::EventType type, MemoryEvent::Detail detail, int slot, int targetId = -1,
+        int affectedPointers = 0) {
+        // 새 이벤트를 블록(과 ASSIGN이면 대상)의 기록 사슬 머리로 연결
+        uint64_t index = events.totalCount();
+        int targetSlot = type == MemoryEvent::EventType::ASSIGN && targetId != -1 ? slotOf(targetId) : -1;
+        const MemoryEvent event{ type, detail, (uint16_t)min(affectedPointers, 0xFFFF), blocks.id[slot], targetId,
+            blocks.cold[slot].nameId, logicalClock++, lastEventOf[slot],
+            targetSlot != -1 ? lastAssignTo[targetSlot] : MemoryEvent::NO_EVENT };
+        events.push(event);
+        lastEventOf.set(slot, index);
+        if (targetSlot != -1) lastAssignTo.set(targetSlot, index);
+        if (trace && !traceSuspended) {
+            TraceEventRecord record{ (uint8_t)type, (uint8_t)detail,
+                (uint8_t)(blocks.pointer[slot] ? TRACE_FLAG_POINTER : 0), 0,
+                event.blockId, event.targetId, event.nameId, blocks.size[slot], event.timestamp };
+            trace->append(record, blocks.names);
+        }
+        stateVersion++;
+    }
+
+    // 블록 ID에 대응하는 slot 반환 (없으면 -1)
+    int slotOf(int id) const {
+        if (id >= 0 && (size_t)id < idToSlot.size()) {
+            int slot = idToSlot[id];
+            if (slot != -1) return slot;
+        }
+        if (externalIdToSlot.empty()) return -1;
+        auto it = externalIdToSlot.find(id);
+        return it != externalIdToSlot.end() ? it->second : -1;
+    }
+
+    // 새 블록 ID 발급 (외부에서 등록된 ID와 겹치지 않도록 건너뜀)
+    int issueId() {
+        while (!externalIdToSlot.empty() && externalIdToSlot.count(nextId)) {
+            nextId++;
+        }
+        return nextId++;
+    }
+
+    // ID 인덱스에 등록 (조밀한 범위 밖이면 보조 인덱스)
+    void bindId(int id, int slot) {
+        if (id >= 0 && id < nextId + DENSE_ID_SLACK) {
+            if ((size_t)id >= idToSlot.size()) {
+                idToSlot.resize((size_t)id + 1, -1);
+            }
+            idToSlot.set(id, slot);
+        }
+        else {
+            externalIdToSlot[id] = slot;
+        }
+    }
+
+    // 재사용하는 slot에 새 ID 발급 (이전 블록의 ID는 더 이상 조회되지 않고, 기록 사슬도 새로 시작)
+    int reissueId(int slot) {
+        int oldId = blocks.id[slot];
+        if (oldId >= 0 && (size_t)oldId < idToSlot.size() && idToSlot[oldId] == slot) {
+            idToSlot.set(oldId, -1);
+        }
+        else {
+            externalIdToSlot.erase(oldId);
+        }
+        int id = issueId();
+        blocks.id.set(slot, id);
+        bindId(id, slot);
+        lastEventOf.set(slot, MemoryEvent::NO_EVENT);
+        lastAssignTo.set(slot, MemoryEvent::NO_EVENT);
+        createdBlocks++;
+        return id;
+    }
+
+    // 새 블록을 저장하고 ID 인덱스에 등록
+    int insertBlock(const BlockRecord& block) {
+        int slot = blocks.append(block);
+        firstReferrer.push_back(-1);
+        nextReferrer.push_back(-1);
+        prevReferrer.push_back(-1);
+        linkedTarget.push_back(-1);
+        nextEdge.push_back(-1);
+        prevEdge.push_back(-1);
+        incomingCount.push_back(0);
+        leakPos.push_back(-1);
+        lastEventOf.push_back(MemoryEvent::NO_EVENT);
+        lastAssignTo.push_back(MemoryEvent::NO_EVENT);
+        bindId(block.id, slot);
+        createdBlocks++;
+        if (block.isAllocated) {
+            countAllocated(block.type, block.size);
+        }
+        if (block.type == MemoryType::HEAP && block.isAllocated) {
+            addLeak(slot);
+        }
+        if (block.type == MemoryType::STACK && block.isAllocated) {
+            stackLocals.push_back(slot);
+        }
+        return slot;
+    }
+
+    void countAllocated(MemoryType type, uint64_t size) {
+        if (type == MemoryType::STACK) {
+            stats.stackBytes += size;
+            stats.stackBlocks++;
+            stats.peakStackBytes = max(stats.peakStackBytes, stats.stackBytes);
+            stats.peakStackBlocks = max(stats.peakStackBlocks, stats.stackBlocks);
+        }
+        else {
+            stats.heapBytes += size;
+            stats.heapBlocks++;
+            stats.peakHeapBytes = max(stats.peakHeapBytes, stats.heapBytes);
+            stats.peakHeapBlocks = max(stats.peakHeapBlocks, stats.heapBlocks);
+            int sizeClass = MemoryStats::sizeClass(size);
+            stats.liveBySize[sizeClass]++;
+            stats.allocatedBySize[sizeClass]++;
+        }
+        peakBytes = max(peakBytes, stats.stackBytes + stats.heapBytes);
+    }
+
+    void countReleased(MemoryType type, uint64_t size) {
+        if (type == MemoryType::STACK) {
+            stats.stackBytes -= size;
+            stats.stackBlocks--;
+        }
+        else {
+            stats.heapBytes -= size;
+            stats.heapBlocks--;
+            stats.liveBySize[MemoryStats::sizeClass(size)]--;
+        }
+    }
+
+    void addLeak(int slot) {
+        leakPos.set(slot, (int)leaks.size());
+        leaks.push_back(blocks.id[slot]);
+    }
+
+    void removeLeak(int slot) {
+        int pos = leakPos[slot];
+        if (pos == -1) return;
+        int lastSlot = slotOf(leaks.back());
+        leaks.set(pos, leaks.back());
+        leakPos.set(lastSlot, pos);
+        leaks.pop_back();
+        leakPos.set(slot, -1);
+    }
+
+    // 연산 중 쌓인 누수 전이를 현재 누수 판정 모드 기준의 LEAK 이벤트로 기록
+    void flushLeakEvents() {
+        if (leakMode == LeakMode::REACHABILITY) {
+            pendingLeakEvents.clear();
+            if (!linksChanged) return;
+            linksChanged = false;
+            markReachable(markBits);
+            size_t count = min(blocks.count(), reachableMarks.size() * 64);
+            for (size_t slot = 0; slot < count; slot++) {
+                if (blocks.type[slot] == MemoryType::HEAP && blocks.allocated[slot] &&
+                    isMarked(reachableMarks, slot) && !isMarked(markBits, slot)) {
+                    addEvent(MemoryEvent::EventType::LEAK, MemoryEvent::Detail::UNREACHABLE, (int)slot);
+                }
+            }
+            reachableMarks.swap(markBits);
+            return;
+        }
+
+        for (int slot : pendingLeakEvents) {
+            if (leakPos[slot] == -1) continue;
+            addEvent(MemoryEvent::EventType::LEAK, MemoryEvent::Detail::UNREACHABLE, slot);
+        }
+        pendingLeakEvents.clear();
+    }
+
+    // 모드 변경, 복원, 초기화 뒤 REACHABILITY 이벤트의 비교 기준을 지금 상태로 맞춤
+    void resetReachableMarks() {
+        linksChanged = false;
+        if (leakMode == LeakMode::REACHABILITY) markReachable(reachableMarks);
+        else reachableMarks.clear();
+    }
+
+    // 포인터 slot을 대상 slot의 역참조 리스트에 연결
+    void linkReferrer(int ptrSlot) {
+        if (!blocks.pointer[ptrSlot] || !blocks.allocated[ptrSlot] || blocks.pointsTo[ptrSlot] == -1) return;
+
+        int targetSlot = slotOf(blocks.pointsTo[ptrSlot]);
+        if (targetSlot == -1) return;
+        linksChanged = true;
+
+        int head = firstReferrer[targetSlot];
+        nextReferrer.set(ptrSlot, head);
+        prevReferrer.set(ptrSlot, -1);
+        if (head != -1) prevReferrer.set(head, ptrSlot);
+        firstReferrer.set(targetSlot, ptrSlot);
+        linkedTarget.set(ptrSlot, targetSlot);
+
+        if (incomingCount.ref(targetSlot)++ == 0) {
+            removeLeak(targetSlot);
+        }
+
+        nextEdge.set(ptrSlot, -1);
+        prevEdge.set(ptrSlot, lastEdge);
+        if (lastEdge != -1) nextEdge.set(lastEdge, ptrSlot);
+        else firstEdge = ptrSlot;
+        lastEdge = ptrSlot;
+    }
+
+    // 포인터 slot을 현재 대상의 역참조 리스트에서 제거
+    void unlinkReferrer(int ptrSlot) {
+        int targetSlot = linkedTarget[ptrSlot];
+        if (targetSlot == -1) return;
+        linksChanged = true;
+
+        int prev = prevReferrer[ptrSlot];
+        int next = nextReferrer[ptrSlot];
+        if (prev != -1) nextReferrer.set(prev, next);
+        else firstReferrer.set(targetSlot, next);
+        if (next != -1) prevReferrer.set(next, prev);
+        nextReferrer.set(ptrSlot, -1);
+        prevReferrer.set(ptrSlot, -1);
+        linkedTarget.set(ptrSlot, -1);
+
+        // 마지막 포인터를 잃은 힙 블록은 도달 불가능 -> 누수
+        if (--incomingCount.ref(targetSlot) == 0 &&
+            blocks.type[targetSlot] == MemoryType::HEAP && blocks.allocated[targetSlot]) {
+            addLeak(targetSlot);
+            pendingLeakEvents.push_back(targetSlot);
+        }
+
+        int prevSlot = prevEdge[ptrSlot];
+        int nextSlot = nextEdge[ptrSlot];
+        if (prevSlot != -1) nextEdge.set(prevSlot, nextSlot);
+        else firstEdge = nextSlot;
+        if (nextSlot != -1) prevEdge.set(nextSlot, prevSlot);
+        else lastEdge = prevSlot;
+        nextEdge.set(ptrSlot, -1);
+        prevEdge.set(ptrSlot, -1);
+    }
+
+public:
+    // 상태 체크포인트 (시간 여행용)
+    // 열들이 쓰기 시 복사 배열이므로 저장/복원은 청크 포인터만 복사하고, 이벤트 기록은 개수만 남겨
+    // 복원할 때 그 뒤를 잘라냄. 이름 표는 추가만 되고 같은 이름은 같은 ID가 되므로 저장하지 않음
+    struct Checkpoint {
+        CowVector<int> id;
+        CowVector<MemoryType> type;
+        CowVector<unsigned char> allocated;
+        CowVector<unsigned char> pointer;
+        CowVector<int> pointsTo;
+        CowVector<size_t> size;
+        CowVector<BlockColdData> cold;
+
+        CowVector<int> idToSlot;
+        unordered_map<int, int> externalIdToSlot;
+        CowVector<int> firstReferrer;
+        CowVector<int> nextReferrer;
+        CowVector<int> prevReferrer;
+        CowVector<int> linkedTarget;
+        CowVector<int> nextEdge;
+        CowVector<int> prevEdge;
+        int firstEdge = -1;
+        int lastEdge = -1;
+        CowVector<int> incomingCount;
+        CowVector<int> leaks;
+        CowVector<int> leakPos;
+        CowVector<uint64_t> lastEventOf;
+        CowVector<uint64_t> lastAssignTo;
+
+        int nextId = 1;
+        uint64_t stackTop = STACK_BASE;
+        CowVector<int> stackLocals;
+        CowVector<StackFrame> stackFrames;
+        uint64_t peakBytes = 0;
+        uint64_t createdBlocks = 0;
+        MemoryStats stats;
+        uint64_t logicalClock = 0;
+        uint64_t eventCount = 0;
+        shared_ptr<const AllocatorModel> allocator;
+    };
+
+    // 메모리 관리자 초기화
+    MemoryManager()
+        : nextId(1), peakBytes(0), logicalClock(0),
+        leakMode(LeakMode::DIRECT_REFERENCE), stateVersion(1), reachableVersion(0),
+        allocator(makeAllocatorModel(allocatorKind)) {
+    }
+
+    ~MemoryManager() { stopTrace(); }
+
+    MemoryManager(const MemoryManager&) = delete;
+    MemoryManager& operator=(const MemoryManager&) = delete;
+
+    // 스택 변수 생성 (지역 변수, isPointer면 nullptr로 초기화된 포인터)
+    int createStackVariable(string_view name, size_t size, bool isPointer = false) {
+        MEMVIZ_PROFILE_SCOPE("MemoryManager::createStackVariable");
+        if (!freeStackSlots.empty()) {
+            int slot = freeStackSlots.back();
+            freeStackSlots.pop_back();
+            void* address = (void*)(uintptr_t)pushStackAddress(size);
+            blocks.allocated.set(slot, true);
+            blocks.pointer.set(slot, isPointer);
+            blocks.pointsTo.set(slot, -1);
+            blocks.size.set(slot, size);
+            blocks.cold.set(slot, BlockColdData{ blocks.names.intern(name), address, 0, PointerType::RAW, 0, 0, 0, 0, false, false });
+            int id = reissueId(slot);
+            countAllocated(MemoryType::STACK, size);
+            stackLocals.push_back(slot);
+            addEvent(MemoryEvent::EventType::ALLOCATE, MemoryEvent::Detail::STACK_CREATE, slot);
+            return id;
+        }
+
+        BlockRecord block;
+        block.id = issueId();
+        block.name = name;
+        block.size = size;
+        block.type = MemoryType::STACK;
+        block.address = (void*)(uintptr_t)pushStackAddress(size);
+        block.isAllocated = true;
+        block.isPointer = isPointer;
+        block.pointerType = PointerType::RAW;
+        block.pointsTo = -1;
+        int slot = insertBlock(block);
+
+        addEvent(MemoryEvent::EventType::ALLOCATE, MemoryEvent::Detail::STACK_CREATE, slot);
+
+        return block.id;
+    }
+
+    // 힙 메모리 할당 (동적 메모리, 주소는 할당자 모델이 정함)
+    int allocateHeap(string_view name, size_t size, PointerType ptrType = PointerType::RAW) {
+        uint64_t address = allocator->allocate(size);
+        return allocateHeapAt(name, size, (void*)(uintptr_t)address, ptrType, address != 0);
+    }
+
+    // 주소가 정해진 힙 할당 (실제 프로그램에서 가로챈 할당 등)
+    int allocateHeap(string_view name, size_t size, void* address, PointerType ptrType = PointerType::RAW) {
+        return allocateHeapAt(name, size, address, ptrType, false);
+    }
+
+    // 외부에서 ID가 정해진 블록 등록 (트레이스 등)
+    bool registerBlock(const BlockRecord& block) {
+        if (block.id < 0 || slotOf(block.id) != -1) return false;
+        bool dense = block.id < nextId + DENSE_ID_SLACK;
+        int slot = insertBlock(block);
+        if (dense && block.id >= nextId) {
+            nextId = block.id + 1;
+        }
+        linkReferrer(slot);
+        flushLeakEvents();
+        stateVersion++;
+        return true;
+    }
+
+    // 메모리 해제 (delete 수행)
+    bool deallocate(int blockId) {
+        MEMVIZ_PROFILE_SCOPE("MemoryManager::deallocate");
+        int slot = slotOf(blockId);
+        if (slot == -1 || !blocks.allocated[slot]) return false;
+
+        // 해제되는 블록 자신이 포인터라면 대상의 역참조 리스트에서 빠짐
+        unlinkReferrer(slot);
+        blocks.allocated.set(slot, false);
+        countReleased(blocks.type[slot], blocks.size[slot]);
+        removeLeak(slot);
+        const BlockColdData& cold = blocks.cold[slot];
+        if (cold.simulatedAddress) {
+            allocator->release((uint64_t)(uintptr_t)cold.address, blocks.size[slot]);
+        }
+
+        // 이 블록을 가리키던 포인터들만 nullptr로 변경 (O(참조 수))
+        int nulled = 0;
+        while (firstReferrer[slot] != -1) {
+            int ptrSlot = firstReferrer[slot];
+            unlinkReferrer(ptrSlot);
+            blocks.pointsTo.set(ptrSlot, -1);
+            nulled++;
+        }
+
+        addEvent(MemoryEvent::EventType::DEALLOCATE, MemoryEvent::Detail::FREE, slot, -1, nulled);
+        flushLeakEvents();
+        if (reuseFreedBlocks && blocks.type[slot] == MemoryType::HEAP) {
+            freeHeapSlots.push_back(slot);
+        }
+
+        return true;
+    }
+
+    // 포인터 변수에 주소 할당 (ptr = &var 또는 ptr = ptr2)
+    bool assignPointer(int pointerBlockId, int targetBlockId) {
+        MEMVIZ_PROFILE_SCOPE("MemoryManager::assignPointer");
+        int slot = slotOf(pointerBlockId);
+        if (slot == -1) return false;
+
+        unlinkReferrer(slot);
+        blocks.pointsTo.set(slot, targetBlockId);
+        linkReferrer(slot);
+
+        addEvent(MemoryEvent::EventType::ASSIGN, MemoryEvent::Detail::POINTER_ASSIGN, slot, targetBlockId);
+        flushLeakEvents();
+
+        return true;
+    }
+
+    // 스택 변수 하나 해제 (트레이스 재생용, 이 변수를 가리키던 포인터는 그대로 둠)
+    bool releaseStackVariable(int blockId, MemoryEvent::Detail detail = MemoryEvent::Detail::EXIT_FREE) {
+        MEMVIZ_PROFILE_SCOPE("MemoryManager::releaseStackVariable");
+        int slot = slotOf(blockId);
+        if (slot == -1 || blocks.type[slot] != MemoryType::STACK || !blocks.allocated[slot]) return false;
+        releaseStackSlot(slot, detail);
+        return true;
+    }
+
+    // 스코프 진입: 프레임 표시를 남기고 프레임 경계를 16바이트로 정렬
+    void pushStackFrame() {
+        stackFrames.push_back(StackFrame{ stackTop, (int)stackLocals.size() });
+        stackTop &= ~(STACK_ALIGNMENT - 1);
+    }
+
+    // 스코프 종료: 그 프레임의 지역 변수만 해제하고 스택 포인터를 프레임 진입 시점으로 되돌림
+    bool popStackFrame() {
+        MEMVIZ_PROFILE_SCOPE("MemoryManager::popStackFrame");
+        if (stackFrames.empty()) return false;
+        StackFrame frame = stackFrames.back();
+        stackFrames.pop_back();
+        releaseLocalsFrom(frame.firstLocal, MemoryEvent::Detail::SCOPE_FREE);
+        stackTop = frame.savedTop;
+        return true;
+    }
+
+    int getStackFrameDepth() const { return (int)stackFrames.size(); }
+
+    // 프로그램 종료 시 모든 스택 메모리 정리 (살아있는 스택 변수 목록만 되감음)
+    void clearAllStack() {
+        releaseLocalsFrom(0, MemoryEvent::Detail::EXIT_FREE);
+        stackFrames.clear();
+        stackTop = STACK_BASE;
+    }
+
+    // 트레이스 기록 시작 (reset 직후 호출, 이후 reset마다 같은 파일 뒤에 새 세션을 이어 기록)
+    bool startTrace(const string& path) {
+        stopTrace();
+        trace = make_unique<TraceWriter>();
+        if (!trace->open(path)) {
+            trace.reset();
+            return false;
+        }
+        return true;
+    }
+
+    // 남은 이벤트와 인덱스를 기록하고 트레이스 종료
+    void stopTrace() {
+        if (trace) trace->finish(blocks.names);
+        trace.reset();
+    }
+
+    bool isTracing() const { return trace != nullptr; }
+
+    // 기록 중인 트레이스를 파일에 반영 (세션은 계속 기록)
+    void syncTrace() {
+        if (trace) trace->sync(blocks.names);
+    }
+
+    // 트레이스 레코드 하나를 적용 (재생용), 적용된 블록 ID 반환 (실패 시 -1)
+    int applyTraceEvent(const TraceEventRecord& record, string_view name, int blockId, int targetId) {
+        auto type = (MemoryEvent::EventType)record.type;
+        auto detail = (MemoryEvent::Detail)record.detail;
+
+        switch (type) {
+        case MemoryEvent::EventType::ALLOCATE:
+            if (detail == MemoryEvent::Detail::STACK_CREATE) {
+                return createStackVariable(name, (size_t)record.size, (record.flags & TRACE_FLAG_POINTER) != 0);
+            }
+            return allocateHeap(name, (size_t)record.size);
+        case MemoryEvent::EventType::DEALLOCATE:
+            if (detail == MemoryEvent::Detail::EXIT_FREE || detail == MemoryEvent::Detail::SCOPE_FREE) {
+                return releaseStackVariable(blockId, detail) ? blockId : -1;
+            }
+            return deallocate(blockId) ? blockId : -1;
+        case MemoryEvent::EventType::ASSIGN:
+            return assignPointer(blockId, targetId) ? blockId : -1;
+        case MemoryEvent::EventType::LEAK:
+            // 누수 이벤트는 다른 이벤트를 적용하면서 다시 생성됨
+            return blockId;
+        }
+        return -1;
+    }
+
+    // 메모리 누수 감지 (현재 누수 판정 모드 기준)
+    vector<int> detectLeaks() const {
+        MEMVIZ_PROFILE_SCOPE("MemoryManager::detectLeaks");
+        const auto& current = getLeaks();
+        return vector<int>(current.begin(), current.end());
+    }
+
+    // 현재 누수 블록 ID 집합 (복사 없음)
+    // DIRECT_REFERENCE는 증분 관리되는 집합을 그대로, REACHABILITY는 상태가 바뀐 경우에만 재계산
+    const CowVector<int>& getLeaks() const {
+        if (leakMode == LeakMode::DIRECT_REFERENCE) return leaks;
+        if (reachableVersion != stateVersion) {
+            computeUnreachable(unreachableLeaks);
+            reachableVersion = stateVersion;
+        }
+        return unreachableLeaks;
+    }
+    size_t getLeakCount() const { return getLeaks().size(); }
+
+    void setLeakMode(LeakMode mode) {
+        leakMode = mode;
+        resetReachableMarks();
+    }
+    LeakMode getLeakMode() const { return leakMode; }
+
+    static bool isMarked(const vector<unsigned long long>& marks, size_t slot) {
+        return (marks[slot >> 6] >> (slot & 63)) & 1;
+    }
+
+    // 스택 루트에서 도달할 수 있는 slot 표시 (mark 단계)
+    // 간선 배열은 linkedTarget(slot -> 대상 slot)을 그대로 사용함: 포인터의 진출 간선은
+    // 최대 1개이므로 CSR의 오프셋 배열이 필요 없고, 방문 표시는 비트셋으로 관리
+    void markReachable(vector<unsigned long long>& marks) const {
+        size_t count = blocks.count();
+        marks.assign((count + 63) / 64, 0);
+
+        const auto& type = blocks.type;
+        const auto& allocated = blocks.allocated;
+
+        for (size_t root = 0; root < count; root++) {
+            if (type[root] != MemoryType::STACK || !allocated[root]) continue;
+
+            // 진출 간선이 하나뿐이므로 체인을 따라가다 이미 표시된 블록을 만나면 중단
+            int slot = (int)root;
+            while (slot != -1) {
+                unsigned long long bit = 1ULL << (slot & 63);
+                unsigned long long& word = marks[slot >> 6];
+                if (word & bit) break;
+                word |= bit;
+                slot = linkedTarget[slot];
+            }
+        }
+    }
+
+    // 스택 루트에서 도달할 수 없는 힙 블록 계산
+    void computeUnreachable(CowVector<int>& out) const {
+        MEMVIZ_PROFILE_SCOPE("MemoryManager::computeUnreachable");
+        out.clear();
+        markReachable(markBits);
+
+        size_t count = blocks.count();
+        for (size_t slot = 0; slot < count; slot++) {
+            if (blocks.type[slot] == MemoryType::HEAP && blocks.allocated[slot] && !isMarked(markBits, slot)) {
+                out.push_back(blocks.id[slot]);
+            }
+        }
+    }
+
+    // 현재 누수 블록들의 전체 크기
+    uint64_t getLeakedBytes() const {
+        uint64_t total = 0;
+        for (int id : getLeaks()) {
+            MemoryBlock block = findBlock(id);
+            if (block) total += block.size();
+        }
+        return total;
+    }
+
+    uint64_t getLiveBytes() const { return stats.stackBytes + stats.heapBytes; }
+    uint64_t getPeakBytes() const { return peakBytes; }
+
+    // 현재 통계 (할당자 모델 힙 수치 포함)
+    MemoryStats getStats() const {
+        MemoryStats result = stats;
+        result.simulatedHeap = allocator->getFootprint() > 0;
+        result.heapExtent = allocator->currentExtent();
+        result.heapReserved = allocator->getReservedBytes();
+        result.heapRequested = allocator->getRequestedBytes();
+        return result;
+    }
+    size_t getBlockCount() const { return (size_t)createdBlocks; }
+
+    // 블록으로 들어오는 살아있는 포인터 수
+    int getIncomingCount(int blockId) const {
+        int slot = slotOf(blockId);
+        return slot != -1 ? incomingCount[slot] : 0;
+    }
+
+    // 블록을 가리키는 살아있는 포인터 ID 목록
+    vector<int> getReferrers(int blockId) const {
+        vector<int> result;
+        int slot = slotOf(blockId);
+        if (slot == -1) return result;
+        for (int p = firstReferrer[slot]; p != -1; p = nextReferrer[p]) {
+            result.push_back(blocks.id[p]);
+        }
+        return result;
+    }
+
+    // 현재 연결된 포인터마다 visit(포인터 블록) 호출 (연결 순서, 할당 없음)
+    template <typename Fn>
+    void forEachPointerEdge(Fn&& visit) const {
+        for (int slot = firstEdge; slot != -1; slot = nextEdge[slot]) visit(MemoryBlock(&blocks, slot));
+    }
+
+    // ID로 메모리 블록 찾기 (없으면 빈 뷰)
+    MemoryBlock findBlock(int id) const {
+        int slot = slotOf(id);
+        return slot != -1 ? MemoryBlock(&blocks, slot) : MemoryBlock();
+    }
+
+    const BlockStore& getBlockStore() const { return blocks; }
+    const EventHistory& getEvents() const { return events; }
+
+    // 이벤트 보존 개수와 디스크 기록 경로 설정 (빈 경로면 디스크 기록 없음)
+    void setEventRetention(size_t capacity, const string& spillPath = "") {
+        events.setRetention(capacity, spillPath);
+        // 기록이 비었으므로 사슬도 끊음
+        lastEventOf.assign(blocks.count(), MemoryEvent::NO_EVENT);
+        lastAssignTo.assign(blocks.count(), MemoryEvent::NO_EVENT);
+    }
+
+    string_view getName(uint32_t nameId) const { return blocks.names.get(nameId); }
+
+    // 이벤트 설명 문구 출력 (출력 시점에만 문자열 조립)
+    void describeEvent(ostream& out, const MemoryEvent& event) const {
+        string_view name = getName(event.nameId);
+        switch (event.detail) {
+        case MemoryEvent::Detail::STACK_CREATE:
+            out << "스택 변수 생성: " << name;
+            break;
+        case MemoryEvent::Detail::HEAP_ALLOCATE:
+            out << "힙 메모리 할당: " << name;
+            break;
+        case MemoryEvent::Detail::FREE:
+            out << "메모리 해제: " << name;
+            break;
+        case MemoryEvent::Detail::EXIT_FREE:
+            out << "프로그램 종료로 변수 해제: " << name;
+            break;
+        case MemoryEvent::Detail::SCOPE_FREE:
+            out << "스코프 종료로 변수 해제: " << name;
+            break;
+        case MemoryEvent::Detail::POINTER_ASSIGN: {
+            out << "포인터 연결: " << name << " -> ";
+            MemoryBlock target = findBlock(event.targetId);
+            if (event.targetId == -1) out << "nullptr";
+            else if (target) out << target.name();
+            else out << "(unknown)";
+            break;
+        }
+        case MemoryEvent::Detail::UNREACHABLE:
+            out << "메모리 누수 발생: " << name;
+            break;
+        }
+    }
+
+    // 블록 하나의 기록을 시간순으로 수집: 블록 자신의 이벤트와 그 블록을 가리킨 ASSIGN
+    // 두 사슬을 인덱스가 큰 쪽부터 합치며 거슬러 올라가므로 전체 기록 크기와 무관하게 O(해당 블록 이벤트 수)
+    // slot이 재사용된 경우 지금 블록의 할당 이벤트에서 멈춤
+    // 링 버퍼에서 밀려났고 디스크 기록도 없는 이벤트를 만나면 그 사슬은 거기서 끊기고 false
+    bool getBlockHistory(int blockId, vector<pair<uint64_t, MemoryEvent>>& out) const {
+        out.clear();
+        int slot = slotOf(blockId);
+        if (slot == -1) return true;
+
+        uint64_t own = lastEventOf[slot];
+        uint64_t assigned = lastAssignTo[slot];
+        bool complete = true;
+        MemoryEvent event;
+        while (own != MemoryEvent::NO_EVENT || assigned != MemoryEvent::NO_EVENT) {
+            bool fromOwn = assigned == MemoryEvent::NO_EVENT || (own != MemoryEvent::NO_EVENT && own >= assigned);
+            uint64_t index = fromOwn ? own : assigned;
+            if (!events.read(index, event)) {
+                complete = false;
+                (fromOwn ? own : assigned) = MemoryEvent::NO_EVENT;
+                continue;
+            }
+            out.emplace_back(index, event);
+            if (fromOwn && event.type == MemoryEvent::EventType::ALLOCATE) break;
+            // 자기 자신을 가리키는 ASSIGN은 두 사슬에 모두 있음
+            if (own == index) own = event.prevOfBlock;
+            if (assigned == index) assigned = event.prevOfTarget;
+        }
+        reverse(out.begin(), out.end());
+        return complete;
+    }
+
+    // 이름이 같은 블록 ID 목록 (최근에 만든 블록부터, O(블록 수))
+    vector<int> findBlocksByName(string_view name) const {
+        vector<int> ids;
+        for (size_t slot = blocks.count(); slot-- > 0;) {
+            if (blocks.name((int)slot) == name) ids.push_back(blocks.id[slot]);
+        }
+        return ids;
+    }
+
+    // 변수/블록 이름(또는 #ID)의 생애 출력: 할당, 가리킨 포인터들, 해제, 누수 (같은 이름은 최근 limit개)
+    void printBlockHistory(ostream& out, string_view query, size_t limit = 8) const {
+        vector<int> ids;
+        if (query.size() > 1 && query[0] == '#') {
+            int id = atoi(string(query.substr(1)).c_str());
+            if (slotOf(id) != -1) ids.push_back(id);
+        }
+        else {
+            ids = findBlocksByName(query);
+        }
+        if (ids.empty()) {
+            out << "'" << query << "' 블록이 없습니다\n";
+            return;
+        }
+
+        vector<pair<uint64_t, MemoryEvent>> history;
+        for (size_t i = 0; i < ids.size() && i < limit; i++) {
+            int slot = slotOf(ids[i]);
+            bool complete = getBlockHistory(ids[i], history);
+            out << blocks.name(slot) << " (#" << ids[i] << ", "
+                << (blocks.type[slot] == MemoryType::STACK ? "스택" : "힙") << ' ' << blocks.size[slot]
+                << " bytes, @" << blocks.cold[slot].address << ", "
+                << (blocks.allocated[slot] ? "할당됨" : "해제됨") << ") 이벤트 " << history.size() << "개\n";
+            if (!complete) {
+                out << "  ... 이전 이벤트는 기록에서 밀려나 볼 수 없음 (--event-spill로 보존)\n";
+            }
+            for (const auto& [index, event] : history) {
+                out << "  #" << index << ' ' << MemoryEvent::typeTag(event.type);
+                describeEvent(out, event);
+                if (event.affectedPointers > 0) {
+                    if (event.detail == MemoryEvent::Detail::FREE) {
+                        out << " (가리키던 포인터 " << event.affectedPointers << "개가 nullptr이 됨)";
+                    }
+                    else {
+                        out << " (포인터 " << event.affectedPointers << "개가 해제된 변수를 계속 가리킴)";
+                    }
+                }
+                out << '\n';
+            }
+        }
+        if (ids.size() > limit) {
+            out << "같은 이름의 블록 " << ids.size() - limit << "개 더 있음 (#ID로 조회)\n";
+        }
+    }
+
+    // 현재 상태를 체크포인트로 저장
+    void saveCheckpoint(Checkpoint& out) const {
+        out.id = blocks.id;
+        out.type = blocks.type;
+        out.allocated = blocks.allocated;
+        out.pointer = blocks.pointer;
+        out.pointsTo = blocks.pointsTo;
+        out.size = blocks.size;
+        out.cold = blocks.cold;
+
+        out.idToSlot = idToSlot;
+        out.externalIdToSlot = externalIdToSlot;
+        out.firstReferrer = firstReferrer;
+        out.nextReferrer = nextReferrer;
+        out.prevReferrer = prevReferrer;
+        out.linkedTarget = linkedTarget;
+        out.nextEdge = nextEdge;
+        out.prevEdge = prevEdge;
+        out.firstEdge = firstEdge;
+        out.lastEdge = lastEdge;
+        out.incomingCount = incomingCount;
+        out.leaks = leaks;
+        out.leakPos = leakPos;
+        out.lastEventOf = lastEventOf;
+        out.lastAssignTo = lastAssignTo;
+
+        out.nextId = nextId;
+        out.stackTop = stackTop;
+        out.stackLocals = stackLocals;
+        out.stackFrames = stackFrames;
+        out.stats = stats;
+        out.peakBytes = peakBytes;
+        out.createdBlocks = createdBlocks;
+        out.logicalClock = logicalClock;
+        out.eventCount = events.totalCount();
+        out.allocator = allocator->clone();
+    }
+
+    // 체크포인트 시점으로 되돌림 (그 뒤 이벤트 기록은 버림)
+    void restoreCheckpoint(const Checkpoint& checkpoint) {
+        blocks.id = checkpoint.id;
+        blocks.type = checkpoint.type;
+        blocks.allocated = checkpoint.allocated;
+        blocks.pointer = checkpoint.pointer;
+        blocks.pointsTo = checkpoint.pointsTo;
+        blocks.size = checkpoint.size;
+        blocks.cold = checkpoint.cold;
+
+        idToSlot = checkpoint.idToSlot;
+        externalIdToSlot = checkpoint.externalIdToSlot;
+        firstReferrer = checkpoint.firstReferrer;
+        nextReferrer = checkpoint.nextReferrer;
+        prevReferrer = checkpoint.prevReferrer;
+        linkedTarget = checkpoint.linkedTarget;
+        nextEdge = checkpoint.nextEdge;
+        prevEdge = checkpoint.prevEdge;
+        firstEdge = checkpoint.firstEdge;
+        lastEdge = checkpoint.lastEdge;
+        incomingCount = checkpoint.incomingCount;
+        leaks = checkpoint.leaks;
+        leakPos = checkpoint.leakPos;
+        lastEventOf = checkpoint.lastEventOf;
+        lastAssignTo = checkpoint.lastAssignTo;
+        pendingLeakEvents.clear();
+        freeHeapSlots.clear();
+        freeStackSlots.clear();
+
+        nextId = checkpoint.nextId;
+        stackTop = checkpoint.stackTop;
+        stackLocals = checkpoint.stackLocals;
+        stackFrames = checkpoint.stackFrames;
+        stats = checkpoint.stats;
+        peakBytes = checkpoint.peakBytes;
+        createdBlocks = checkpoint.createdBlocks;
+        logicalClock = checkpoint.logicalClock;
+        if (checkpoint.allocator) allocator = checkpoint.allocator->clone();
+        events.truncate(checkpoint.eventCount);
+        resetReachableMarks();
+        stateVersion++;
+    }
+
+    // 트레이스 기록 일시 중지 (이미 기록한 구간을 다시 실행할 때)
+    void setTraceSuspended(bool suspended) { traceSuspended = suspended; }
+
+    // 해제된 힙 블록 재사용 여부 (켜면 해제된 블록은 조회할 수 없게 되므로 단계 이동과 함께 쓰지 않음)
+    void setBlockReuse(bool enabled) {
+        reuseFreedBlocks = enabled;
+        if (!enabled) {
+            freeHeapSlots.clear();
+            freeStackSlots.clear();
+        }
+    }
+
+    // 힙 주소 할당자 모델 교체 (이미 할당된 블록의 주소는 그대로 둠)
+    void setAllocator(AllocatorKind kind) {
+        allocatorKind = kind;
+        allocator = makeAllocatorModel(kind);
+    }
+
+    AllocatorKind getAllocatorKind() const { return allocatorKind; }
+
+    // 할당자 모델 힙이 차지했던 최대 주소 범위
+    uint64_t getHeapFootprint() const { return allocator->getFootprint(); }
+    // 모델 힙에 공간이 없어 주소 없이 만든 블록 수
+    uint64_t getFailedAllocations() const { return allocator->getFailedAllocations(); }
+
+    // 메모리 관리자 초기화 (모든 데이터 삭제)
+    void reset() {
+        // 트레이스는 닫지 않고 같은 파일에 다음 세션으로 이어 기록
+        if (trace) trace->beginSession(blocks.names);
+        blocks.clear();
+        events.clear();
+        idToSlot.clear();
+        externalIdToSlot.clear();
+        firstReferrer.clear();
+        nextReferrer.clear();
+        prevReferrer.clear();
+        linkedTarget.clear();
+        nextEdge.clear();
+        prevEdge.clear();
+        firstEdge = -1;
+        lastEdge = -1;
+        incomingCount.clear();
+        leaks.clear();
+        leakPos.clear();
+        lastEventOf.clear();
+        lastAssignTo.clear();
+        pendingLeakEvents.clear();
+        unreachableLeaks.clear();
+        reachableMarks.clear();
+        linksChanged = false;
+        freeHeapSlots.clear();
+        freeStackSlots.clear();
+        allocator->clear();
+        stateVersion++;
+        nextId = 1;
+        stackTop = STACK_BASE;
+        stackLocals.clear();
+        stackFrames.clear();
+        stats = MemoryStats();
+        peakBytes = 0;
+        createdBlocks = 0;
+        logicalClock = 0;
+    }
+};
+
+// ==================== 트레이스 재생 ====================
+
+// 트레이스 파일을 메모리 매핑해 읽고 MemoryManager 상태를 재구성함
+class TraceReader {
+private:
+    const char* data;
+    size_t length;
+#ifdef _WIN32
+    vector<char> buffer;
+#else
+    int fd;
+#endif
+
+    vector<string_view> strings;
+    // EVTS 세그먼트 목록 (첫 이벤트 인덱스 오름차순) - 이벤트 탐색은 이 배열의 이진 탐색
+    vector<TraceIndexEntry> eventSegments;
+    // 두 번째 세션부터 각 세션의 첫 이벤트 인덱스 (첫 세션은 항상 0에서 시작)
+    vector<uint64_t> sessionStarts;
+    uint64_t totalEvents;
+    bool complete;
+
+    template <typename T>
+    bool readAt(uint64_t offset, T& out) const {
+        if (offset + sizeof(T) > length) return false;
+        memcpy(&out, data + offset, sizeof(T));
+        return true;
+    }
+
+    bool loadStrings(uint64_t offset) {
+        TraceSegmentHeader header;
+        if (!readAt(offset, header) || header.tag != TRACE_TAG_STRINGS) return false;
+        uint64_t pos = offset + sizeof(header);
+        uint64_t end = pos + header.payloadBytes;
+        if (end > length) return false;
+        for (uint32_t i = 0; i < header.count; i++) {
+            uint32_t size;
+            if (!readAt(pos, size) || pos + sizeof(size) + size > end) return false;
+            strings.emplace_back(data + pos + sizeof(size), size);
+            pos += sizeof(size) + size;
+        }
+        return true;
+    }
+
+    // 세그먼트 하나를 분류해 문자열 또는 이벤트 목록에 반영
+    bool addSegment(uint64_t firstEvent, uint64_t offset) {
+        TraceSegmentHeader header;
+        if (!readAt(offset, header)) return false;
+        if (header.tag == TRACE_TAG_STRINGS) return loadStrings(offset);
+        if (header.tag == TRACE_TAG_EVENTS) {
+            if (offset + sizeof(header) + header.payloadBytes > length) return false;
+            eventSegments.push_back({ firstEvent, offset });
+            totalEvents = firstEvent + header.count;
+        }
+        else if (header.tag == TRACE_TAG_SESSION) {
+            sessionStarts.push_back(firstEvent);
+        }
+        return true;
+    }
+
+    // 종료 레코드가 있으면 INDX 체인을 거슬러 올라가며 세그먼트 목록 구성
+    bool loadFromIndex() {
+        size_t endSize = sizeof(TraceSegmentHeader) + sizeof(TraceEndRecord);
+        if (length < sizeof(TraceFileHeader) + endSize) return false;
+
+        TraceSegmentHeader header;
+        TraceEndRecord end;
+        if (!readAt(length - endSize, header) || header.tag != TRACE_TAG_END) return false;
+        readAt(length - sizeof(TraceEndRecord), end);
+
+        vector<vector<TraceIndexEntry>> blocks;
+        uint64_t indexOffset = end.lastIndexOffset;
+        while (indexOffset != 0) {
+            TraceSegmentHeader indexHeader;
+            uint64_t previous;
+            if (!readAt(indexOffset, indexHeader) || indexHeader.tag != TRACE_TAG_INDEX) return false;
+            if (!readAt(indexOffset + sizeof(indexHeader), previous)) return false;
+
+            vector<TraceIndexEntry> entries(indexHeader.count);
+            uint64_t entryOffset = indexOffset + sizeof(indexHeader) + sizeof(previous);
+            if (entryOffset + entries.size() * sizeof(TraceIndexEntry) > length) return false;
+            memcpy(entries.data(), data + entryOffset, entries.size() * sizeof(TraceIndexEntry));
+            blocks.push_back(move(entries));
+
+            if (previous >= indexOffset) return false;
+            indexOffset = previous;
+        }
+
+        for (auto it = blocks.rbegin(); it != blocks.rend(); ++it) {
+            for (const auto& entry : *it) {
+                if (!addSegment(entry.firstEvent, entry.offset)) return false;
+            }
+        }
+        complete = true;
+        return totalEvents == end.totalEvents;
+    }
+
+    // 비정상 종료된 파일: 세그먼트 헤더를 순서대로 훑어 목록 구성
+    void loadByScan() {
+        strings.clear();
+        eventSegments.clear();
+        sessionStarts.clear();
+        totalEvents = 0;
+        complete = false;
+
+        uint64_t offset = sizeof(TraceFileHeader);
+        TraceSegmentHeader header;
+        while (readAt(offset, header)) {
+            uint64_t next = offset + sizeof(header) + header.payloadBytes;
+            if (next > length) break;
+            if (!addSegment(totalEvents, offset)) break;
+            offset = next;
+        }
+    }
+
+public:
+    TraceReader()
+        : data(nullptr), length(0),
+#ifndef _WIN32
+        fd(-1),
+#endif
+        totalEvents(0), complete(false) {
+    }
+    ~TraceReader() { close(); }
+
+    TraceReader(const TraceReader&) = delete;
+    TraceReader& operator=(const TraceReader&) = delete;
+
+    bool open(const string& path) {
+        close();
+#ifdef _WIN32
+        FILE* file = fopen(path.c_str(), "rb");
+        if (!file) return false;
+        fseek(file, 0, SEEK_END);
+        long size = ftell(file);
+        fseek(file, 0, SEEK_SET);
+        buffer.resize(size > 0 ? (size_t)size : 0);
+        size_t got = fread(buffer.data(), 1, buffer.size(), file);
+        fclose(file);
+        data = buffer.data();
+        length = got;
+#else
+        fd = ::open(path.c_str(), O_RDONLY);
+        if (fd < 0) return false;
+        struct stat info;
+        if (fstat(fd, &info) != 0 || info.st_size < (off_t)sizeof(TraceFileHeader)) {
+            close();
+            return false;
+        }
+        void* mapped = mmap(nullptr, (size_t)info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (mapped == MAP_FAILED) {
+            close();
+            return false;
+        }
+        data = static_cast<const char*>(mapped);
+        length = (size_t)info.st_size;
+#endif
+
+        TraceFileHeader header;
+        if (!readAt(0, header) || memcmp(header.magic, "MVTRACE", 8) != 0 ||
+            header.version < TRACE_MIN_VERSION || header.version > TRACE_VERSION ||
+            header.recordSize != sizeof(TraceEventRecord)) {
+            close();
+            return false;
+        }
+
+        if (!loadFromIndex()) loadByScan();
+        return true;
+    }
+
+    void close() {
+#ifdef _WIN32
+        buffer.clear();
+#else
+        if (data) munmap(const_cast<char*>(data), length);
+        if (fd >= 0) ::close(fd);
+        fd = -1;
+#endif
+        data = nullptr;
+        length = 0;
+        strings.clear();
+        eventSegments.clear();
+        sessionStarts.clear();
+        totalEvents = 0;
+        complete = false;
+    }
+
+    uint64_t eventCount() const { return totalEvents; }
+    // 파일에 이어 기록된 실행 세션 수 (관리자가 초기화될 때마다 하나씩 늘어남)
+    size_t sessionCount() const { return sessionStarts.size() + 1; }
+    // index번째 세션의 첫 이벤트 인덱스
+    uint64_t sessionStart(size_t index) const { return index == 0 ? 0 : sessionStarts[index - 1]; }
+    // 종료 레코드까지 정상 기록된 파일인지 여부
+    bool isComplete() const { return complete; }
+
+    string_view name(uint32_t id) const {
+        return id < strings.size() ? strings[id] : string_view();
+    }
+
+    // 인덱스로 이벤트 읽기: 세그먼트 목록 이진 탐색 O(log n)
+    bool readEvent(uint64_t index, TraceEventRecord& out) const {
+        if (index >= totalEvents) return false;
+        auto it = upper_bound(eventSegments.begin(), eventSegments.end(), index,
+            [](uint64_t value, const TraceIndexEntry& entry) { return value < entry.firstEvent; });
+        --it;
+        uint64_t offset = it->offset + sizeof(TraceSegmentHeader) +
+            (index - it->firstEvent) * sizeof(TraceEventRecord);
+        return readAt(offset, out);
+    }
+
+    // 처음부터 count개 이벤트를 적용해 상태 재구성 (manager는 초기화됨)
+    // 세션 경계를 지나면 기록할 때처럼 관리자를 다시 초기화하므로 결과는 마지막 세션의 상태
+    bool replay(MemoryManager& manager, uint64_t count) const {
+        manager.reset();
+        if (count > totalEvents) count = totalEvents;
+
+        // 재생 중 발급되는 ID가 기록과 다를 수 있으므로 기록 ID -> 새 ID 대응표 유지
+        unordered_map<int, int> idMap;
+        auto mapId = [&idMap](int id) {
+            if (idMap.empty()) return id;
+            auto it = idMap.find(id);
+            return it != idMap.end() ? it->second : id;
+        };
+
+        uint64_t applied = 0;
+        size_t nextSession = 0;
+        for (const auto& segment : eventSegments) {
+            TraceSegmentHeader header;
+            readAt(segment.offset, header);
+            const char* records = data + segment.offset + sizeof(header);
+
+            for (uint32_t i = 0; i < header.count && applied < count; i++, applied++) {
+                if (nextSession < sessionStarts.size() && sessionStarts[nextSession] == applied) {
+                    manager.reset();
+                    idMap.clear();
+                    nextSession++;
+                }
+
+                TraceEventRecord record;
+                memcpy(&record, records + (size_t)i * sizeof(record), sizeof(record));
+
+                int newId = manager.applyTraceEvent(record, name(record.nameId),
+                    mapId(record.blockId), mapId(record.targetId));
+                if (newId != -1 && newId != record.blockId) idMap[record.blockId] = newId;
+            }
+            if (applied >= count) break;
+        }
+        return applied == count;
+    }
+};
+
+// ==================== 프레임 렌더러 ====================
+
+// 표준 출력이 터미널인지 (파이프/파일이면 커서 이동 없이 전체 프레임을 그대로 출력)
+bool stdoutIsTerminal() {
+#ifdef _WIN32
+    return false;
+#else
+    return isatty(STDOUT_FILENO) != 0;
+#endif
+}
+
+// 표준 에러가 터미널인지 (진행 표시 여부)
+bool stderrIsTerminal() {
+#ifdef _WIN32
+    return _isatty(_fileno(stderr)) != 0;
+#else
+    return isatty(STDERR_FILENO) != 0;
+#endif
+}
+
+// 터미널 높이 (알 수 없으면 0)
+size_t terminalRows() {
+#ifdef _WIN32
+    return 0;
+#else
+    winsize size{};
+    if (ioctl(STDOUT_FILENO, TIOCGWINSZ, &size) != 0) return 0;
+    return size.ws_row;
+#endif
+}
+
+// 터미널 너비 (알 수 없으면 0)
+size_t terminalColumns() {
+#ifdef _WIN32
+    return 0;
+#else
+    winsize size{};
+    if (ioctl(STDOUT_FILENO, TIOCGWINSZ, &size) != 0) return 0;
+    return size.ws_col;
+#endif
+}
+
+// 코드 포인트가 터미널에서 차지하는 칸 수 (한글/한자/전각/그림 문자는 2칸)
+int codepointWidth(uint32_t cp) {
+    bool wide = (cp >= 0x1100 && cp <= 0x115F) || (cp >= 0x2E80 && cp <= 0xA4CF) ||
+        (cp >= 0xAC00 && cp <= 0xD7A3) || (cp >= 0xF900 && cp <= 0xFAFF) ||
+        (cp >= 0xFE30 && cp <= 0xFE4F) || (cp >= 0xFF00 && cp <= 0xFF60) ||
+        (cp >= 0xFFE0 && cp <= 0xFFE6) || (cp >= 0x1F300 && cp <= 0x1FAFF) ||
+        (cp >= 0x20000 && cp <= 0x3FFFD);
+    return wide ? 2 : 1;
+}
+
+// 한 줄을 화면 너비 columns칸 안으로 자름 (ANSI 이스케이프는 폭 0, 잘랐으면 색을 되돌림)
+void truncateRow(string& row, size_t columns) {
+    size_t shown = 0;
+    size_t i = 0;
+    while (i < row.size()) {
+        unsigned char ch = (unsigned char)row[i];
+        if (ch == '\033') {
+            // CSI: ESC [ ... 종료 문자(0x40~0x7E)
+            size_t end = i + 1;
+            if (end < row.size() && row[end] == '[') {
+                end++;
+                while (end < row.size() && !((unsigned char)row[end] >= 0x40 && (unsigned char)row[end] <= 0x7E)) end++;
+            }
+            i = min(end + 1, row.size());
+            continue;
+        }
+
+        size_t length = ch < 0x80 ? 1 : ch >= 0xF0 ? 4 : ch >= 0xE0 ? 3 : ch >= 0xC0 ? 2 : 1;
+        uint32_t cp = length == 1 ? ch : ch & (0xFF >> (length + 1));
+        for (size_t k = 1; k < length && i + k < row.size(); k++) cp = (cp << 6) | ((unsigned char)row[i + k] & 0x3F);
+        size_t width = codepointWidth(cp);
+        if (shown + width > columns) {
+            row.resize(i);
+            row += "\033[0m";
+            return;
+        }
+        shown += width;
+        i += length;
+    }
+}
+
+// 프레임 버퍼 렌더러
+// 한 프레임을 화면 밖 버퍼에 모두 그린 뒤 이전 프레임과 줄 단위로 비교해서
+// 바뀐 줄만 ANSI 커서 이동과 함께 한 번의 write로 내보냄 (깜빡임 없음)
+class FrameRenderer {
+private:
+    ostream& out;
+    bool diffEnabled;
+    bool valid = false;           // 화면에 previousRows가 그대로 남아 있는지
+    vector<string> previousRows;
+    vector<string> currentRows;
+    string output;
+
+    // 비동기 출력: 완성된 출력 버퍼를 쓰기 스레드에 순서대로 넘기고 바로 돌아감
+    // (느린 터미널에 쓰는 동안 실행이 멈추지 않게 함, 자동 재생 중에만 사용)
+    bool async = false;
+    bool stopping = false;
+    deque<string> queue;
+    mutex queueLock;
+    condition_variable queueChanged;
+    thread writer;
+
+    void writerLoop() {
+        unique_lock<mutex> guard(queueLock);
+        while (true) {
+            queueChanged.wait(guard, [&] { return stopping || !queue.empty(); });
+            if (queue.empty()) return;
+            string chunk = move(queue.front());
+            queue.pop_front();
+            guard.unlock();
+            out.write(chunk.data(), (streamsize)chunk.size());
+            out.flush();
+            guard.lock();
+        }
+    }
+
+    static void splitRows(const string& frame, vector<string>& rows) {
+        size_t count = 0;
+        size_t start = 0;
+        while (start < frame.size()) {
+            size_t end = frame.find('\n', start);
+            if (end == string::npos) end = frame.size();
+            if (count == rows.size()) rows.emplace_back();
+            rows[count++].assign(frame, start, end - start);
+            start = end + 1;
+        }
+        rows.resize(count);
+    }
+
+    void moveCursor(size_t row) {
+        output += "\033[";
+        output += to_string(row + 1);
+        output += ";1H";
+    }
+
+    void write() {
+        if (async) {
+            {
+                lock_guard<mutex> guard(queueLock);
+                queue.push_back(move(output));
+            }
+            queueChanged.notify_one();
+            output.clear();
+            return;
+        }
+        out.write(output.data(), (streamsize)output.size());
+        out.flush();
+    }
+
+    static constexpr const char* CLEAR_SCREEN = "\033[H\033[2J";
+
+public:
+    FrameRenderer(ostream& out, bool diffEnabled) : out(out), diffEnabled(diffEnabled) {}
+    ~FrameRenderer() { setAsync(false); }
+
+    FrameRenderer(const FrameRenderer&) = delete;
+    FrameRenderer& operator=(const FrameRenderer&) = delete;
+
+    // 쓰기 스레드 사용 여부 (끌 때는 남은 출력을 모두 쓴 뒤 돌아옴)
+    void setAsync(bool enabled) {
+#ifdef _WIN32
+        // 화면 지우기가 system("cls")라 출력 순서를 맞출 수 없으므로 항상 직접 씀
+        enabled = false;
+#endif
+        if (enabled == async) return;
+        if (enabled) {
+            stopping = false;
+            async = true;
+            writer = thread(&FrameRenderer::writerLoop, this);
+            return;
+        }
+        {
+            lock_guard<mutex> guard(queueLock);
+            stopping = true;
+        }
+        queueChanged.notify_one();
+        writer.join();
+        async = false;
+    }
+
+    // 다른 출력이 화면을 바꿨으므로 다음 프레임은 전체를 다시 그림
+    void invalidate() {
+        valid = false;
+    }
+
+    // 화면 지우기 (커서를 맨 위로)
+    void clear() {
+#ifdef _WIN32
+        out.flush();
+        system("cls");
+#else
+        output = CLEAR_SCREEN;
+        write();
+#endif
+        valid = false;
+    }
+
+    void present(const string& frame) {
+        splitRows(frame, currentRows);
+
+        // 터미널보다 긴 줄은 자동 줄바꿈으로 여러 줄을 차지해 커서 위치가 어긋나므로 한 칸 모자라게 자름
+        // (마지막 칸까지 채우면 줄바꿈 대기 상태에서 지우기가 마지막 글자를 지움)
+        size_t columns = terminalColumns();
+        if (columns > 1) {
+            for (auto& row : currentRows) truncateRow(row, columns - 1);
+        }
+
+        // Enter 입력의 줄바꿈까지 화면 안에 들어와야 스크롤 없이 같은 위치에 다시 그릴 수 있음
+        size_t rows = terminalRows();
+        bool diff = diffEnabled && valid && rows > 0 && currentRows.size() + 2 <= rows;
+
+        if (!diff) {
+            // 화면 지우기와 프레임을 한 버퍼에 담아 한 번에 씀
+#ifdef _WIN32
+            clear();
+            output.clear();
+#else
+            output = CLEAR_SCREEN;
+#endif
+            for (const auto& row : currentRows) {
+                output += row;
+                output += '\n';
+            }
+        }
+        else {
+            output.clear();
+            for (size_t i = 0; i < currentRows.size(); i++) {
+                if (i < previousRows.size() && previousRows[i] == currentRows[i]) continue;
+                moveCursor(i);
+                output += "\033[0m";
+                output += currentRows[i];
+                output += "\033[K";
+            }
+            // 프레임 아래(이전 프레임의 남은 줄, 입력 에코)는 지우고 커서를 프레임 바로 아래에 둠
+            moveCursor(currentRows.size());
+            output += "\033[J";
+        }
+        write();
+
+        previousRows.swap(currentRows);
+        valid = diffEnabled;
+    }
+};
+
+// ==================== 화면 출력 ====================
+
+class Visualizer {
+private:
+    string colorReset = "\033[0m";
+    string colorRed = "\033[31m";
+    string colorGreen = "\033[32m";
+    string colorYellow = "\033[33m";
+    string colorBlue = "\033[34m";
+    string colorMagenta = "\033[35m";
+    string colorCyan = "\033[36m";
+    string colorBold = "\033[1m";
+
+    FrameRenderer renderer;
+    ostringstream frame;
+
+    void printSeparator(ostream& os, char ch, int width) const {
+        os << string(width, ch) << '\n';
+    }
+
+    // 스택 메모리 영역 출력 (살아있는 블록 수만큼 찾으면 멈춤)
+    void printStack(ostream& os, const BlockStore& blocks, uint64_t liveCount) const {
+        if (liveCount == 0) {
+            os << "│ (비어있음)" << '\n';
+            return;
+        }
+        for (size_t slot = 0; slot < blocks.count() && liveCount > 0; slot++) {
+            if (blocks.type[slot] == MemoryType::STACK && blocks.allocated[slot]) {
+                liveCount--;
+                string_view name = blocks.name((int)slot);
+                os << "│ " << colorBlue;
+                os << name;
+                for (size_t i = name.length(); i < 15; i++) os << " ";
+
+                if (blocks.pointer[slot]) {
+                    os << " [ptr]          ";
+                }
+                else {
+                    os << " [val]          ";
+                }
+
+                os << blocks.size[slot] << "bytes";
+                os << colorReset << '\n';
+            }
+        }
+    }
+
+    // 힙 메모리 영역 출력 (살아있는 블록 수만큼 찾으면 멈춤)
+    void printHeap(ostream& os, const BlockStore& blocks, uint64_t liveCount) const {
+        if (liveCount == 0) {
+            os << "│ (비어있음)" << '\n';
+            return;
+        }
+        for (size_t slot = 0; slot < blocks.count() && liveCount > 0; slot++) {
+            if (blocks.type[slot] == MemoryType::HEAP && blocks.allocated[slot]) {
+                liveCount--;
+                string_view name = blocks.name((int)slot);
+                os << "│ " << colorRed;
+                os << name;
+                for (size_t i = name.length(); i < 30; i++) os << " ";
+                os << blocks.size[slot] << "bytes";
+                os << colorReset << '\n';
+            }
+        }
+    }
+
+    // 메모리 통계 요약 (현재/최대, 할당자 모델 힙 단편화, 크기 등급별 살아있는 힙 블록)
+    // 비율을 소수 한 자리 백분율로 (숫자만 들어가므로 고정 버퍼로 충분)
+    static string percentText(double ratio) {
+        char text[32];
+        snprintf(text, sizeof(text), "%.1f%%", ratio * 100);
+        return text;
+    }
+
+    void printStats(ostream& os, const MemoryStats& stats) const {
+        os << "  스택 " << stats.stackBlocks << "개 " << stats.stackBytes << "B (최대 "
+            << stats.peakStackBlocks << "개 " << stats.peakStackBytes << "B)   힙 "
+            << stats.heapBlocks << "개 " << stats.heapBytes << "B (최대 "
+            << stats.peakHeapBlocks << "개 " << stats.peakHeapBytes << "B)\n";
+
+        // 모델 힙이 비어 있으면 (모두 해제되어 줄어듦) 생략, 모델을 거치지 않은 힙은 단편화를 알 수 없음
+        if (stats.simulatedHeap && stats.heapExtent > 0) {
+            os << "  힙 범위 " << stats.heapExtent << "B   외부 단편화 " << percentText(stats.externalFragmentation())
+                << "   내부 단편화 " << percentText(stats.internalFragmentation()) << '\n';
+        }
+        else if (!stats.simulatedHeap && stats.peakHeapBlocks > 0) {
+            os << "  힙 범위 n/a   외부 단편화 n/a   내부 단편화 n/a (할당자 모델을 거치지 않은 주소)\n";
+        }
+
+        if (stats.heapBlocks > 0) {
+            os << "  크기별 힙 블록:";
+            for (int i = 0; i < MemoryStats::SIZE_CLASS_COUNT; i++) {
+                if (stats.liveBySize[i] == 0) continue;
+                if (i == MemoryStats::SIZE_CLASS_COUNT - 1) os << " >" << MemoryStats::sizeClassLimit(i - 1);
+                else os << " ≤" << MemoryStats::sizeClassLimit(i);
+                os << ":" << stats.liveBySize[i];
+            }
+            os << '\n';
+        }
+    }
+
+    // 포인터 연결 관계 출력 (ptr -> data), 연결된 간선 수만큼만 순회
+    void printPointerConnections(ostream& os, const MemoryManager& memManager) const {
+        bool hasConnections = false;
+        memManager.forEachPointerEdge([&](const MemoryBlock& block) {
+            hasConnections = true;
+            MemoryBlock target = memManager.findBlock(block.pointsTo());
+
+            os << "  " << colorYellow << block.name() << colorReset;
+            os << " ──> ";
+
+            if (target && target.isAllocated()) {
+                if (target.type() == MemoryType::HEAP)
+                    os << colorRed << target.name() << colorReset;
+                else
+                    os << colorBlue << target.name() << " (Stack)" << colorReset;
+            }
+            else {
+                os << colorRed << "(dangling)" << colorReset;
+            }
+            os << '\n';
+        });
+
+        if (!hasConnections) {
+            os << "  (포인터 연결 없음)" << '\n';
+        }
+    }
+
+    // 이벤트 로그 출력 (최근 count개)
+    void printEventLog(ostream& os, const MemoryManager& memManager, int count) const {
+        memManager.getEvents().forEachRecent(count, [&](const MemoryEvent& event) {
+            const string& color = event.type == MemoryEvent::EventType::ALLOCATE ? colorGreen
+                : event.type == MemoryEvent::EventType::ASSIGN ? colorYellow : colorRed;
+            os << "  " << color << MemoryEvent::typeTag(event.type) << colorReset;
+
+            memManager.describeEvent(os, event);
+            os << '\n';
+        });
+    }
+
+    // 프레임 버퍼 비우고 새 프레임 시작
+    ostream& beginFrame() {
+        frame.str(string());
+        frame.clear();
+        return frame;
+    }
+
+    // 제목 머리글 (줄마다 색을 다시 지정해서 어느 줄만 다시 그려도 색이 유지됨)
+    void printTitle(ostream& os, const char* title) const {
+        os << colorBold << colorCyan << string(70, '=') << colorReset << '\n';
+        os << colorBold << colorCyan << "        " << title << colorReset << '\n';
+        os << colorBold << colorCyan << string(70, '=') << colorReset << '\n';
+        os << '\n';
+    }
+
+    // 누수 경고, 스택/힙 영역, 포인터 연결, 최근 이벤트
+    void printMemoryPanels(ostream& os, const MemoryManager& memManager, const char* boxBottom) const {
+        const auto& blocks = memManager.getBlockStore();
+        MemoryStats stats = memManager.getStats();
+
+        const auto& leaks = memManager.getLeaks();
+        if (!leaks.empty()) {
+            printLeakWarnings(os, leaks, memManager);
+            os << '\n';
+        }
+
+        os << colorBold << colorBlue << "┌─ STACK 메모리 ─────────────────┐" << colorReset << '\n';
+        printStack(os, blocks, stats.stackBlocks);
+        os << colorBlue << boxBottom << colorReset << '\n';
+        os << '\n';
+
+        os << colorBold << colorRed << "┌─ HEAP 메모리 ──────────────────┐" << colorReset << '\n';
+        printHeap(os, blocks, stats.heapBlocks);
+        os << colorRed << boxBottom << colorReset << '\n';
+        os << '\n';
+
+        os << colorBold << colorYellow << "포인터 연결:" << colorReset << '\n';
+        printPointerConnections(os, memManager);
+        os << '\n';
+
+        os << colorBold << colorCyan << "메모리 통계:" << colorReset << '\n';
+        printStats(os, stats);
+        os << '\n';
+
+        os << colorBold << colorGreen << "최근 이벤트:" << colorReset << '\n';
+        printEventLog(os, memManager, 15);
+        os << '\n';
+    }
+
+public:
+    explicit Visualizer(ostream& out = cout)
+        : renderer(out, &out == &cout && stdoutIsTerminal()) {}
+
+    // 화면 지우기
+    void clearScreen() {
+        MEMVIZ_PROFILE_SCOPE("Visualizer::clearScreen");
+        renderer.clear();
+    }
+
+    // 프레임 밖에서 화면에 직접 출력했을 때 호출 (다음 프레임은 전체 다시 그림)
+    void invalidateFrame() {
+        renderer.invalidate();
+    }
+
+    // 화면 쓰기를 별도 스레드에서 할지 (끄면 남은 프레임을 모두 쓴 뒤 돌아옴)
+    void setAsyncOutput(bool enabled) {
+        renderer.setAsync(enabled);
+    }
+
+    // 메모리 누수 경고 출력
+    void printLeakWarnings(ostream& os, const CowVector<int>& leaks, const MemoryManager& memManager) const {
+        if (leaks.empty()) return;
+
+        os << colorBold << colorRed;
+        os << "!! 메모리 누수 감지 !! " << leaks.size() << "개 블록" << colorReset << '\n';
+
+        for (int id : leaks) {
+            MemoryBlock block = memManager.findBlock(id);
+            if (block) {
+                os << "  - " << colorRed << block.name() << " (" << block.size() << " bytes, @"
+                    << block.address() << ")" << colorReset << '\n';
+            }
+        }
+    }
+
+    // 전체 메모리 상태 출력 (최종 결과 화면)
+    void printMemoryState(const MemoryManager& memManager) {
+        MEMVIZ_PROFILE_SCOPE("Visualizer::printMemoryState");
+        ostream& os = beginFrame();
+        printTitle(os, "C++ 메모리 관리 시각화 도구 - 콘솔 버전");
+        printMemoryPanels(os, memManager, "└─────────────────────────────────┘");
+        printSeparator(os, '-', 70);
+
+        // 호출한 쪽이 이어서 출력하므로 다음 프레임은 전체 다시 그림
+        renderer.present(frame.str());
+        renderer.invalidate();
+    }
+
+    // 메모리 상태 출력 (단계별 실행 화면 - 현재 실행 라인 표시)
+    void printMemoryStateWithLine(const MemoryManager& memManager,
+        string_view currentLine,
+        int lineNumber,
+        string_view footer = string_view()) {
+        MEMVIZ_PROFILE_SCOPE("Visualizer::printMemoryStateWithLine");
+        ostream& os = beginFrame();
+        printTitle(os, "C++ 메모리 관리 시각화 도구 - 단계별 실행");
+
+        os << colorBold << colorMagenta << "▶ 현재 실행 라인 " << lineNumber << ": " << colorReset;
+        os << colorYellow << currentLine << colorReset << '\n';
+        os << '\n';
+
+        printMemoryPanels(os, memManager, "└────────────────────────────────┘");
+        printSeparator(os, '-', 70);
+        if (footer.empty()) footer = "▶ Enter를 누르면 다음 단계로 진행합니다...";
+        os << colorGreen << footer << colorReset << '\n';
+
+        renderer.present(frame.str());
+    }
+};
+
+// ==================== 코드 파서 ==================== 
+
+// 스크립트 토큰 (원본 버퍼를 가리키는 string_view, 1부터 시작하는 줄/열 위치)
+struct Token {
+    enum class Kind : unsigned char {
+        Identifier, Number, New, Delete, Nullptr,
+        Star, Amp, Assign, Semicolon, Comma,
+        LParen, RParen, LBrace, RBrace, LBracket, RBracket,
+        Less, Greater, Plus, Minus,
+        Other, End
+    };
+
+    Kind kind;
+    string_view text;
+    int line;
+    int column;
+};
+
+// 한 번 훑으며 줄 단위로 토큰을 만드는 렉서
+// 토큰은 원본을 복사하지 않고 가리키기만 하므로 원본 버퍼가 살아 있는 동안만 유효
+// 줄 주석(//)은 건너뛰고, 토큰 벡터는 호출한 쪽이 재사용
+class ScriptLexer {
+private:
+    string_view source;
+    size_t pos = 0;
+    int lineNumber = 0;
+
+    // 로케일을 거치지 않는 ASCII 문자 분류
+    static bool isDigit(char ch) {
+        return ch >= '0' && ch <= '9';
+    }
+
+    static bool isIdentStart(char ch) {
+        return (ch >= 'a' && ch <= 'z') || (ch >= 'A' && ch <= 'Z') || ch == '_';
+    }
+
+    static bool isIdentChar(char ch) {
+        return isIdentStart(ch) || isDigit(ch);
+    }
+
+    static bool isSpace(char ch) {
+        return ch == ' ' || ch == '\t' || ch == '\r' || ch == '\v' || ch == '\f';
+    }
+
+    static Token::Kind keywordKind(string_view word) {
+        if (word == "new") return Token::Kind::New;
+        if (word == "delete") return Token::Kind::Delete;
+        if (word == "nullptr" || word == "NULL") return Token::Kind::Nullptr;
+        return Token::Kind::Identifier;
+    }
+
+    static Token::Kind punctKind(char ch) {
+        switch (ch) {
+        case '*': return Token::Kind::Star;
+        case '&': return Token::Kind::Amp;
+        case '=': return Token::Kind::Assign;
+        case ';': return Token::Kind::Semicolon;
+        case ',': return Token::Kind::Comma;
+        case '(': return Token::Kind::LParen;
+        case ')': return Token::Kind::RParen;
+        case '{': return Token::Kind::LBrace;
+        case '}': return Token::Kind::RBrace;
+        case '[': return Token::Kind::LBracket;
+        case ']': return Token::Kind::RBracket;
+        case '<': return Token::Kind::Less;
+        case '>': return Token::Kind::Greater;
+        case '+': return Token::Kind::Plus;
+        case '-': return Token::Kind::Minus;
+        default: return Token::Kind::Other;
+        }
+    }
+
+public:
+    explicit ScriptLexer(string_view source) : source(source) {}
+
+    // 다음 줄을 토큰으로 나눔 (마지막은 항상 End 토큰), 더 읽을 줄이 없으면 false
+    bool nextLine(string_view& line, int& number, vector<Token>& tokens) {
+        if (pos >= source.size()) return false;
+
+        size_t end = source.find('\n', pos);
+        if (end == string_view::npos) end = source.size();
+        line = source.substr(pos, end - pos);
+        number = ++lineNumber;
+        pos = end + 1;
+
+        tokens.clear();
+        size_t i = 0;
+        while (i < line.size()) {
+            char ch = line[i];
+            if (isSpace(ch)) {
+                i++;
+                continue;
+            }
+            if (ch == '/' && i + 1 < line.size() && line[i + 1] == '/') break;
+
+            size_t start = i;
+            Token::Kind kind;
+            if (isIdentStart(ch)) {
+                while (i < line.size() && isIdentChar(line[i])) i++;
+                kind = keywordKind(line.substr(start, i - start));
+            }
+            else if (isDigit(ch)) {
+                while (i < line.size() && (isIdentChar(line[i]) || line[i] == '.')) i++;
+                kind = Token::Kind::Number;
+            }
+            else {
+                i++;
+                kind = punctKind(ch);
+            }
+            tokens.push_back({ kind, line.substr(start, i - start), number, (int)start + 1 });
+        }
+        tokens.push_back({ Token::Kind::End, line.substr(line.size()), number, (int)line.size() + 1 });
+        return true;
+    }
+};
+
+// 컴파일된 스크립트 명령 하나
+// 변수는 컴파일할 때 슬롯 번호로 바뀌고, 실행 중에는 슬롯 -> 블록 ID 표만 사용
+struct ScriptOp {
+    enum class Code : unsigned char {
+        DECL,           // a = 새 스택 변수 (name, size, isPointer)
+        NEW,            // 힙 할당(name, size x 개수) 후 a가 0 이상이면 a에 대입
+        DELETE,         // a가 가리키는 블록 해제
+        ASSIGN_ADDR,    // a = &b
+        ASSIGN_PTR,     // a = b (포인터 복사)
+        ASSIGN_NULL,    // a = nullptr
+        SCOPE_ENTER,
+        SCOPE_EXIT,
+        INT_SET,        // a = value (정수 명령의 size는 a의 바이트 크기, nameId는 a의 이름)
+        INT_COPY,       // a = b (정수)
+        INT_ADD,        // a += value
+        LOOP_LT,        // a < 한계가 아니면 target으로 분기
+        LOOP_GT,        // a > 한계가 아니면 target으로 분기
+        JUMP,           // target으로 분기
+        ERROR           // 이 줄에서 실행 실패 (nameId는 실패 이유)
+    };
+
+    Code code;
+    bool isPointer;
+    int a;
+    int b;              // NEW 배열 길이 / 반복 한계 정수 변수 (-1이면 value만 사용)
+    uint32_t nameId;    // DECL/NEW 블록 이름, 정수 명령의 변수 이름, ERROR 이유 (ScriptProgram::names)
+    uint32_t target;    // 분기 명령의 목적지 명령 위치
+    size_t size;        // DECL 크기, NEW 원소 크기, 정수 변수 크기
+    int64_t value;      // 정수 상수, NEW 배열 길이, 반복 한계에 더할 값
+};
+
+// 스크립트 한 줄과 그 줄의 명령 범위 [firstOp, 다음 줄의 firstOp)
+struct ScriptLine {
+    string_view text;
+    int lineNumber;
+    uint32_t firstOp;
+};
+
+// 한 번 컴파일한 스크립트 (다시 실행하거나 단계 이동할 때 재파싱하지 않음)
+struct ScriptProgram {
+    string source;                  // lines[].text가 가리키는 원본
+    vector<ScriptLine> lines;       // 빈 줄/주석만 있는 줄은 제외
+    vector<ScriptOp> ops;
+    StringArena names;
+    int slotCount = 0;
+    int lastLineNumber = 0;
+    bool hasLoops = false;          // 있으면 실행되는 단계 수를 미리 알 수 없음
+
+    void clear() {
+        source.clear();
+        lines.clear();
+        ops.clear();
+        names.clear();
+        slotCount = 0;
+        lastLineNumber = 0;
+        hasLoops = false;
+    }
+};
+
+class ScriptParser {
+private:
+    using Kind = Token::Kind;
+    using Code = ScriptOp::Code;
+
+    MemoryManager& memManager;
+    ScriptProgram program;
+    int scopeLevel;
+
+    // 컴파일 상태
+    vector<Token> tokens;
+    unordered_map<string_view, int> variables;   // 이름 -> 마지막으로 선언된 슬롯
+    // 안쪽 스코프에서 선언된 이름과 그 전 슬롯(-1이면 없었음), 스코프를 닫을 때 되돌림
+    vector<pair<string_view, int>> shadowed;
+    vector<unsigned char> slotIsPointer;
+    // 슬롯의 정수 폭 (바이트, 값이 이 범위를 넘으면 실행 실패. 포인터와 실수는 8)과 이름
+    vector<unsigned char> slotIntBytes;
+    vector<uint32_t> slotNameIds;
+    string heapName;
+
+    // 열린 스코프: shadowed 시작 위치, 반복문 본문이면 카운터 슬롯/증감량/조건 명령 위치
+    struct OpenScope {
+        size_t shadowMark;
+        int loopVar;
+        int64_t loopStep;
+        uint32_t testOp;
+    };
+    vector<OpenScope> scopes;
+
+    // 실행 상태 (currentLine 줄의 pc번째 명령부터 실행할 차례)
+    CowVector<int> slotIds;                     // 슬롯 -> 블록 ID
+    CowVector<int64_t> intValues;               // 슬롯 -> 정수 값
+    size_t currentLine = 0;
+    uint32_t pc = 0;
+    // 마지막 실행 실패 이유 ("줄 N: ...")
+    string lastError;
+
+    static bool isBasicType(string_view type) {
+        return type == "int" || type == "float" || type == "double" ||
+            type == "char" || type == "bool" || type == "long" || type == "short";
+    }
+
+    static size_t getTypeSize(string_view type) {
+        if (type.find("int") != string_view::npos) return 4;
+        if (type.find("double") != string_view::npos) return 8;
+        if (type.find("float") != string_view::npos) return 4;
+        if (type.find("char") != string_view::npos) return 1;
+        if (type.find("long") != string_view::npos) return 8;
+        if (type.find("short") != string_view::npos) return 2;
+        if (type.find("bool") != string_view::npos) return 1;
+        return 4;
+    }
+
+    // first부터 last까지 토큰을 덮는 원본 구간
+    static string_view span(const Token& first, const Token& last) {
+        return string_view(first.text.data(), (size_t)(last.text.data() + last.text.size() - first.text.data()));
+    }
+
+    static bool hasAssign(const Token* tok) {
+        for (; tok->kind != Kind::End; tok++) {
+            if (tok->kind == Kind::Assign) return true;
+        }
+        return false;
+    }
+
+    // 선언문인지 (기본 타입으로 시작하거나 `Type*` 형태)
+    static bool isDeclaration(const Token* tok) {
+        if (tok[0].kind != Kind::Identifier) return false;
+        return isBasicType(tok[0].text) || tok[1].kind == Kind::Star;
+    }
+
+    ScriptOp& emit(Code code, int a = -1, int b = -1, uint32_t nameId = 0, size_t size = 0, bool isPointer = false) {
+        program.ops.push_back({ code, isPointer, a, b, nameId, 0, size, 0 });
+        return program.ops.back();
+    }
+
+    // 정수 변수 slot에 쓰는 명령 (넘침 검사에 쓸 폭과 이름을 함께 담음)
+    ScriptOp& emitInt(Code code, int slot, int source = -1) {
+        return emit(code, slot, source, slotNameIds[slot], slotIntBytes[slot]);
+    }
+
+    // 실행하면 reason으로 실패하는 명령
+    void emitError(string_view reason) {
+        emit(Code::ERROR, -1, -1, program.names.intern(reason));
+    }
+
+    int findSlot(string_view name) const {
+        auto it = variables.find(name);
+        return it == variables.end() ? -1 : it->second;
+    }
+
+    // 10진 정수 상수 (토큰 전체가 숫자여야 함)
+    static bool parseInteger(const Token& tok, int64_t& out) {
+        if (tok.kind != Kind::Number) return false;
+        const char* end = tok.text.data() + tok.text.size();
+        auto result = from_chars(tok.text.data(), end, out);
+        return result.ec == errc() && result.ptr == end;
+    }
+
+    // 정수 피연산자 (상수, -상수, 정수 변수), 상수면 slot은 -1
+    bool parseIntOperand(const Token*& tok, int& slot, int64_t& value) const {
+        bool negative = tok->kind == Kind::Minus;
+        const Token* t = negative ? tok + 1 : tok;
+        if (parseInteger(*t, value)) {
+            if (negative) value = -value;
+            slot = -1;
+            tok = t + 1;
+            return true;
+        }
+        if (negative || t->kind != Kind::Identifier) return false;
+        slot = findSlot(t->text);
+        value = 0;
+        tok = t + 1;
+        return slot >= 0 && !slotIsPointer[slot];
+    }
+
+    // 증감식 (i++, ++i, i--, --i, i += N, i -= N), slot은 대상 정수 변수
+    bool parseIncrement(const Token*& tok, int& slot, int64_t& step) const {
+        const Token* t = tok;
+        bool prefix = (t[0].kind == Kind::Plus || t[0].kind == Kind::Minus) && t[1].kind == t[0].kind;
+        if (prefix) {
+            step = t[0].kind == Kind::Plus ? 1 : -1;
+            t += 2;
+        }
+        if (t->kind != Kind::Identifier) return false;
+        slot = findSlot(t->text);
+        if (slot < 0 || slotIsPointer[slot]) return false;
+        t++;
+
+        if (!prefix) {
+            if (t[0].kind != Kind::Plus && t[0].kind != Kind::Minus) return false;
+            int64_t sign = t[0].kind == Kind::Plus ? 1 : -1;
+            if (t[1].kind == t[0].kind) {
+                step = sign;
+                t += 2;
+            }
+            else if (t[1].kind == Kind::Assign && parseInteger(t[2], step)) {
+                step *= sign;
+                t += 3;
+            }
+            else {
+                return false;
+            }
+        }
+        tok = t;
+        return true;
+    }
+
+    // 변수 선언 (int x; int* ptr = ...; 등)
+    void compileDeclaration(const Token* tok) {
+        const Token* typeEnd = tok;
+        while (typeEnd[1].kind == Kind::Identifier && isBasicType(typeEnd->text) && isBasicType(typeEnd[1].text)) {
+            typeEnd++;
+        }
+        const Token* nameTok = typeEnd + 1;
+        while (nameTok->kind == Kind::Star) nameTok++;
+
+        // 이름 없는 선언: 초기화가 있으면 실패, 없으면 무시
+        if (nameTok->kind != Kind::Identifier) {
+            if (hasAssign(tok)) emitError("선언에 변수 이름이 없습니다");
+            return;
+        }
+
+        bool isPtr = nameTok != typeEnd + 1;
+        string_view type = span(tok[0], *typeEnd);
+        size_t size = isPtr ? sizeof(void*) : getTypeSize(type);
+        bool floating = type.find("float") != string_view::npos || type.find("double") != string_view::npos;
+
+        int slot = program.slotCount++;
+        uint32_t nameId = program.names.intern(nameTok->text);
+        slotIsPointer.push_back(isPtr);
+        slotIntBytes.push_back((unsigned char)(isPtr || floating || size == 0 || size > 8 ? 8 : size));
+        slotNameIds.push_back(nameId);
+        if (!scopes.empty()) shadowed.push_back({ nameTok->text, findSlot(nameTok->text) });
+        variables[nameTok->text] = slot;
+        emit(Code::DECL, slot, -1, nameId, size, isPtr);
+
+        if (nameTok[1].kind != Kind::Assign) return;
+        if (nameTok[2].kind == Kind::New) {
+            compileNew(nameTok->text, nameTok + 3);
+            return;
+        }
+        compileAssignment(slot, nameTok + 2);
+    }
+
+    // new 연산자 (ptr = new int; ptr = new int[n];), tok은 new 다음 토큰
+    // 배열 길이는 상수나 정수 변수, 대상 변수가 없으면 힙 블록만 할당된 채 실패
+    void compileNew(string_view varName, const Token* tok) {
+        const Token* typeLast = nullptr;
+        const Token* t = tok;
+        for (; t->kind != Kind::LParen && t->kind != Kind::LBracket &&
+            t->kind != Kind::Semicolon && t->kind != Kind::End; t++) {
+            typeLast = t;
+        }
+        string_view typeStr = typeLast ? span(*tok, *typeLast) : string_view();
+        size_t elementSize = typeLast && typeLast->kind == Kind::Star ? sizeof(void*) : getTypeSize(typeStr);
+
+        int countSlot = -1;
+        int64_t count = 1;
+        if (t->kind == Kind::LBracket) {
+            t++;
+            if (!parseIntOperand(t, countSlot, count) || t->kind != Kind::RBracket) {
+                emitError("배열 길이는 정수 상수나 정수 변수여야 합니다");
+                return;
+            }
+            if (countSlot < 0 && count < 0) {
+                emitError("배열 길이가 음수입니다: " + to_string(count));
+                return;
+            }
+        }
+
+        heapName.assign(varName.data(), varName.size());
+        heapName += "_data";
+
+        int slot = findSlot(varName);
+        emit(Code::NEW, slot, countSlot, program.names.intern(heapName), elementSize).value = count;
+        if (slot < 0) emitError("선언되지 않은 변수에 new를 대입했습니다: " + string(varName));
+    }
+
+    // delete 연산자 (delete ptr; delete[] ptr;), tok은 delete 다음 토큰
+    void compileDelete(const Token* tok) {
+        if (tok[0].kind == Kind::LBracket && tok[1].kind == Kind::RBracket) tok += 2;
+        int slot = -1;
+        if (tok[0].kind == Kind::Identifier &&
+            (tok[1].kind == Kind::Semicolon || tok[1].kind == Kind::End)) {
+            slot = findSlot(tok[0].text);
+        }
+        if (slot < 0 || !slotIsPointer[slot]) {
+            emitError("delete 대상은 선언된 포인터 변수 하나여야 합니다");
+            return;
+        }
+        emit(Code::DELETE, slot);
+    }
+
+    // 할당 (ptr = &var; ptr = other; ptr = nullptr; n = 10; n = m;), tok은 = 다음 토큰
+    // 알 수 없는 오른쪽 값은 무시
+    void compileAssignment(int leftSlot, const Token* tok) {
+        if (!slotIsPointer[leftSlot]) {
+            const Token* t = tok;
+            int right;
+            int64_t value;
+            if (parseIntOperand(t, right, value) && (t->kind == Kind::Semicolon || t->kind == Kind::End)) {
+                if (right < 0) emitInt(Code::INT_SET, leftSlot).value = value;
+                else emitInt(Code::INT_COPY, leftSlot, right);
+                return;
+            }
+        }
+
+        if (tok[0].kind == Kind::Nullptr) {
+            emit(Code::ASSIGN_NULL, leftSlot);
+            return;
+        }
+
+        if (tok[0].kind == Kind::Amp && tok[1].kind == Kind::Identifier) {
+            int target = findSlot(tok[1].text);
+            if (target >= 0) emit(Code::ASSIGN_ADDR, leftSlot, target);
+            return;
+        }
+
+        if (tok[0].kind == Kind::Identifier) {
+            int right = findSlot(tok[0].text);
+            if (right >= 0 && slotIsPointer[right]) emit(Code::ASSIGN_PTR, leftSlot, right);
+        }
+    }
+
+    void openScope(int loopVar = -1, int64_t loopStep = 0, uint32_t testOp = 0) {
+        scopes.push_back({ shadowed.size(), loopVar, loopStep, testOp });
+        emit(Code::SCOPE_ENTER);
+    }
+
+    // 스코프 안에서 선언된 이름을 바깥 스코프의 슬롯으로 되돌리고 스코프 종료 명령 생성
+    // 반복문 본문이면 증감, 조건으로 돌아가는 분기, 카운터 스코프 종료까지 이어서 생성
+    void closeScope() {
+        OpenScope scope{ shadowed.size(), -1, 0, 0 };
+        if (!scopes.empty()) {
+            scope = scopes.back();
+            scopes.pop_back();
+        }
+        while (shadowed.size() > scope.shadowMark) {
+            auto [name, previous] = shadowed.back();
+            shadowed.pop_back();
+            if (previous < 0) variables.erase(name);
+            else variables[name] = previous;
+        }
+        emit(Code::SCOPE_EXIT);
+
+        if (scope.loopVar >= 0) {
+            emitInt(Code::INT_ADD, scope.loopVar).value = scope.loopStep;
+            emit(Code::JUMP).target = scope.testOp;
+            program.ops[scope.testOp].target = (uint32_t)program.ops.size();
+            closeScope();
+        }
+    }
+
+    // 횟수 반복문 for ([int] i = A; i < B; i++) { (조건은 < <= > >=, 한계는 상수나 정수 변수)
+    // 머리 줄: 카운터 스코프 진입, 초기화, 조건 검사, 본문 스코프 진입
+    // 닫는 줄: 본문 스코프 종료, 증감 후 조건 검사로 분기 (조건이 거짓이면 카운터 스코프 종료로)
+    void compileFor(const Token* tok) {
+        static constexpr const char* FOR_FORM = "for 문은 for ([int] i = A; i < B; i++) { 형식이어야 합니다";
+        if (tok[1].kind != Kind::LParen) {
+            emitError(FOR_FORM);
+            return;
+        }
+        const Token* init = tok + 2;
+        const Token* t = init;
+        while (t->kind != Kind::Semicolon && t->kind != Kind::End) t++;
+        const Token* name = t - 1;
+        for (const Token* a = init; a < t; a++) {
+            if (a->kind == Kind::Assign) {
+                name = a - 1;
+                break;
+            }
+        }
+        if (t->kind != Kind::Semicolon || name < init || name->kind != Kind::Identifier) {
+            emitError(FOR_FORM);
+            return;
+        }
+
+        openScope();
+        if (isDeclaration(init)) {
+            compileDeclaration(init);
+        }
+        else if (name == init && findSlot(name->text) >= 0) {
+            compileAssignment(findSlot(name->text), name + 2);
+        }
+        int var = findSlot(name->text);
+        t++;
+
+        int boundSlot;
+        int64_t bound;
+        int64_t step;
+        int stepSlot;
+        bool ok = var >= 0 && !slotIsPointer[var] && t->kind == Kind::Identifier && findSlot(t->text) == var &&
+            (t[1].kind == Kind::Less || t[1].kind == Kind::Greater);
+        Code test = ok && t[1].kind == Kind::Less ? Code::LOOP_LT : Code::LOOP_GT;
+        bool inclusive = ok && t[2].kind == Kind::Assign;
+        if (ok) {
+            t += inclusive ? 3 : 2;
+            ok = parseIntOperand(t, boundSlot, bound) && t->kind == Kind::Semicolon;
+        }
+        if (ok) {
+            t++;
+            ok = parseIncrement(t, stepSlot, step) && stepSlot == var &&
+                t[0].kind == Kind::RParen && t[1].kind == Kind::LBrace && t[2].kind == Kind::End;
+        }
+        if (!ok) {
+            emitError(FOR_FORM);
+            return;
+        }
+        if (step == 0) {
+            emitError("for 문의 증감량이 0이라 반복이 끝나지 않습니다");
+            return;
+        }
+
+        // i <= B는 i < B + 1, i >= B는 i > B - 1로 검사
+        if (inclusive) bound += test == Code::LOOP_LT ? 1 : -1;
+        uint32_t testOp = (uint32_t)program.ops.size();
+        ScriptOp& op = emit(test, var, boundSlot);
+        op.value = bound;
+        op.target = UINT32_MAX;     // 닫는 괄호에서 채움 (끝내 닫히지 않으면 프로그램 끝)
+        openScope(var, step, testOp);
+        program.hasLoops = true;
+    }
+
+    // 한 줄을 명령으로 컴파일 (tok은 End로 끝나는 그 줄의 토큰)
+    void compileLine(const Token* tok) {
+        if (tok[0].kind == Kind::Identifier && tok[0].text == "int" &&
+            tok[1].kind == Kind::Identifier && tok[1].text == "main" && tok[2].kind == Kind::LParen) {
+            return;
+        }
+
+        if (tok[0].kind == Kind::LBrace && tok[1].kind == Kind::End) {
+            openScope();
+            return;
+        }
+
+        if (tok[0].kind == Kind::RBrace && tok[1].kind == Kind::End) {
+            closeScope();
+            return;
+        }
+
+        if (tok[0].kind == Kind::Identifier && tok[0].text == "for") {
+            compileFor(tok);
+            return;
+        }
+
+        if (tok[0].kind == Kind::Delete) {
+            compileDelete(tok + 1);
+            return;
+        }
+
+        if (tok[0].kind == Kind::Identifier && tok[0].text == "return") return;
+
+        // 역참조 대입(*p = ...)은 지원하지 않음
+        if (tok[0].kind == Kind::Star) {
+            if (hasAssign(tok)) emitError("역참조 대입(*p = ...)은 지원하지 않습니다");
+            return;
+        }
+
+        if (isDeclaration(tok)) {
+            compileDeclaration(tok);
+            return;
+        }
+
+        // 정수 증감 (i++; --i; i += 2;)
+        if (tok[0].kind == Kind::Plus || tok[0].kind == Kind::Minus ||
+            (tok[0].kind == Kind::Identifier && (tok[1].kind == Kind::Plus || tok[1].kind == Kind::Minus))) {
+            int slot;
+            int64_t step;
+            if (parseIncrement(tok, slot, step)) emitInt(Code::INT_ADD, slot).value = step;
+            return;
+        }
+
+        if (tok[0].kind == Kind::Identifier && tok[1].kind == Kind::Assign) {
+            if (tok[2].kind == Kind::New) {
+                compileNew(tok[0].text, tok + 3);
+                return;
+            }
+
+            int left = findSlot(tok[0].text);
+            if (left >= 0) compileAssignment(left, tok + 2);
+        }
+    }
+
+    uint32_t lineEnd(size_t line) const {
+        return line + 1 < program.lines.size() ? program.lines[line + 1].firstOp : (uint32_t)program.ops.size();
+    }
+
+    // target 명령으로 분기 (그 명령이 있는 줄이 다음 단계, 명령 범위를 벗어나면 프로그램 끝)
+    void jumpTo(uint32_t target) {
+        if (target >= program.ops.size()) {
+            currentLine = program.lines.size();
+            pc = (uint32_t)program.ops.size();
+            return;
+        }
+        auto it = upper_bound(program.lines.begin(), program.lines.end(), target,
+            [](uint32_t op, const ScriptLine& line) { return op < line.firstOp; });
+        currentLine = (size_t)(it - program.lines.begin()) - 1;
+        pc = target;
+    }
+
+    int64_t loopBound(const ScriptOp& op) const {
+        return (op.b >= 0 ? intValues[op.b] : 0) + op.value;
+    }
+
+    // 실행 실패: 현재 줄 번호와 이유를 남기고 false
+    bool fail(string_view reason) {
+        lastError = "줄 " + to_string(program.lines[currentLine].lineNumber) + ": ";
+        lastError += reason;
+        return false;
+    }
+
+    // 정수 변수에 값 저장 (선언한 폭의 부호 있는 범위를 넘으면 실패)
+    bool storeInt(const ScriptOp& op, int64_t value) {
+        if (op.size < sizeof(int64_t)) {
+            int64_t limit = (int64_t)1 << (op.size * 8 - 1);
+            if (value < -limit || value >= limit) {
+                return fail("정수 넘침: " + string(program.names.get(op.nameId)) + " = " + to_string(value) +
+                    " (" + to_string(op.size) + "바이트 정수 범위 밖)");
+            }
+        }
+        intValues.set(op.a, value);
+        return true;
+    }
+
+public:
+    ScriptParser(MemoryManager& manager)
+        : memManager(manager), scopeLevel(0) {
+    }
+
+    // 스크립트를 IR로 컴파일 (실패하는 줄은 ERROR 명령이 되므로 컴파일 자체는 항상 성공)
+    // 스크립트는 내부 버퍼로 한 번만 복사하고, 줄/토큰은 모두 그 버퍼를 가리킴
+    void compile(string_view script) {
+        MEMVIZ_PROFILE_SCOPE("ScriptParser::compile");
+        program.clear();
+        variables.clear();
+        shadowed.clear();
+        scopes.clear();
+        slotIsPointer.clear();
+        slotIntBytes.clear();
+        slotNameIds.clear();
+        program.source.assign(script.data(), script.size());
+
+        ScriptLexer lexer(program.source);
+        string_view line;
+        int lineNumber = 0;
+
+        while (lexer.nextLine(line, lineNumber, tokens)) {
+            if (tokens.front().kind == Kind::End) continue;
+            program.lines.push_back({ line, lineNumber, (uint32_t)program.ops.size() });
+            compileLine(tokens.data());
+        }
+        program.lastLineNumber = lineNumber;
+
+        // 컴파일이 끝나면 이름 표는 필요 없음 (키가 원본 버퍼를 가리킴)
+        variables.clear();
+        shadowed.clear();
+        scopes.clear();
+    }
+
+    // 컴파일된 스크립트를 처음부터 실행 (줄마다 실행 전에 stepCallback 호출)
+    bool run(const function<void(string_view, int)>& stepCallback) {
+        beginRun();
+
+        while (!isFinished()) {
+            if (stepCallback) {
+                const ScriptLine& line = getCurrentLine();
+                stepCallback(line.text, line.lineNumber);
+            }
+
+            if (!executeStep()) {
+                return false;
+            }
+        }
+
+        if (stepCallback) {
+            stepCallback(EXIT_STEP_TEXT, getExitLineNumber());
+        }
+
+        finishRun();
+
+        return true;
+    }
+
+    // ---- 한 단계씩 외부에서 구동 (시간 여행 등) ----
+    // 단계는 줄 하나를 실행하는 것이고, 반복문이 있으면 같은 줄이 여러 단계가 됨
+    // 모든 줄을 지나면 프로그램 종료 직전 상태 (isFinished)
+
+    static constexpr const char* EXIT_STEP_TEXT = "// 프로그램 종료 - 스택 메모리 정리 중...";
+
+    // 인터프리터 상태 (슬롯 표도 쓰기 시 복사 배열이라 저장이 쌈)
+    struct RunState {
+        CowVector<int> slotIds;
+        CowVector<int64_t> intValues;
+        int scopeLevel = 0;
+        size_t currentLine = 0;
+        uint32_t pc = 0;
+    };
+
+    void beginRun() {
+        lastError.clear();
+        slotIds.assign(program.slotCount, -1);
+        intValues.assign(program.slotCount, 0);
+        scopeLevel = 0;
+        currentLine = 0;
+        pc = 0;
+    }
+
+    // 반복문이 없으면 단계 수는 줄 수와 같음 (있으면 실행해 봐야 앎)
+    bool hasFixedStepCount() const { return !program.hasLoops; }
+    size_t getLineCount() const { return program.lines.size(); }
+    bool isFinished() const { return currentLine >= program.lines.size(); }
+    const ScriptLine& getCurrentLine() const { return program.lines[currentLine]; }
+    int getExitLineNumber() const { return program.lastLineNumber + 1; }
+    // 마지막 실행 실패 이유 (실패하지 않았으면 빈 문자열)
+    const string& getLastError() const { return lastError; }
+
+    // 현재 줄의 남은 명령 실행, ERROR를 만나면 false
+    // 분기가 일어나면 그 자리에서 단계를 끝내고 목적지 줄에서 이어감
+    bool executeStep() {
+        MEMVIZ_PROFILE_SCOPE("ScriptParser::executeStep");
+        uint32_t end = lineEnd(currentLine);
+        while (pc < end) {
+            const ScriptOp& op = program.ops[pc++];
+            switch (op.code) {
+            case Code::DECL:
+                slotIds.set(op.a, memManager.createStackVariable(program.names.get(op.nameId), op.size, op.isPointer));
+                intValues.set(op.a, 0);
+                break;
+
+            case Code::NEW: {
+                int64_t count = op.b >= 0 ? intValues[op.b] : op.value;
+                if (count < 0) return fail("배열 길이가 음수입니다: " + to_string(count));
+                if ((uint64_t)count > SIZE_MAX / op.size) {
+                    return fail("배열 크기가 너무 큽니다: " + to_string(count) + " x " + to_string(op.size) + "바이트");
+                }
+                int heapId = memManager.allocateHeap(program.names.get(op.nameId), op.size * (size_t)count, PointerType::RAW);
+                if (op.a >= 0) memManager.assignPointer(slotIds[op.a], heapId);
+                break;
+            }
+
+            case Code::DELETE: {
+                // 해제 시 이 블록을 가리키던 모든 포인터(ptr 포함)가 nullptr로 바뀜
+                MemoryBlock ptrBlock = memManager.findBlock(slotIds[op.a]);
+                if (!ptrBlock) return fail("delete 대상 변수가 아직 선언되지 않았습니다");
+                if (ptrBlock.pointsTo() != -1) {
+                    memManager.deallocate(ptrBlock.pointsTo());
+                }
+                break;
+            }
+
+            case Code::ASSIGN_ADDR:
+                memManager.assignPointer(slotIds[op.a], slotIds[op.b]);
+                break;
+
+            case Code::ASSIGN_PTR: {
+                MemoryBlock rightBlock = memManager.findBlock(slotIds[op.b]);
+                if (rightBlock) memManager.assignPointer(slotIds[op.a], rightBlock.pointsTo());
+                break;
+            }
+
+            case Code::ASSIGN_NULL:
+                memManager.assignPointer(slotIds[op.a], -1);
+                break;
+
+            case Code::SCOPE_ENTER:
+                scopeLevel++;
+                memManager.pushStackFrame();
+                break;
+
+            // 짝이 맞는 여는 괄호가 없으면(main 함수 끝 등) 프로그램 종료 때 정리
+            case Code::SCOPE_EXIT:
+                if (scopeLevel > 0) {
+                    scopeLevel--;
+                    memManager.popStackFrame();
+                }
+                break;
+
+            case Code::INT_SET:
+                if (!storeInt(op, op.value)) return false;
+                break;
+
+            case Code::INT_COPY:
+                if (!storeInt(op, intValues[op.b])) return false;
+                break;
+
+            case Code::INT_ADD: {
+                int64_t current = intValues[op.a];
+                if (op.value > 0 ? current > INT64_MAX - op.value : current < INT64_MIN - op.value) {
+                    return fail("정수 넘침: " + string(program.names.get(op.nameId)) + " += " + to_string(op.value));
+                }
+                if (!storeInt(op, current + op.value)) return false;
+                break;
+            }
+
+            case Code::LOOP_LT:
+                if (intValues[op.a] < loopBound(op)) break;
+                jumpTo(op.target);
+                return true;
+
+            case Code::LOOP_GT:
+                if (intValues[op.a] > loopBound(op)) break;
+                jumpTo(op.target);
+                return true;
+
+            case Code::JUMP:
+                jumpTo(op.target);
+                return true;
+
+            case Code::ERROR:
+                return fail(program.names.get(op.nameId));
+            }
+        }
+        currentLine++;
+        return true;
+    }
+
+    // 프로그램 종료 (남은 스택 변수 해제)
+    void finishRun() {
+        memManager.clearAllStack();
+    }
+
+    void saveState(RunState& out) const {
+        out.slotIds = slotIds;
+        out.intValues = intValues;
+        out.scopeLevel = scopeLevel;
+        out.currentLine = currentLine;
+        out.pc = pc;
+    }
+
+    void restoreState(const RunState& state) {
+        slotIds = state.slotIds;
+        intValues = state.intValues;
+        scopeLevel = state.scopeLevel;
+        currentLine = state.currentLine;
+        pc = state.pc;
+    }
+
+    // 스크립트를 한 줄씩 단계별로 실행 (컴파일 후 실행)
+    bool executeScriptStepByStep(string_view script,
+        function<void(string_view, int)> stepCallback) {
+        compile(script);
+        return run(stepCallback);
+    }
+
+    // 컴파일된 스크립트 (명령 수, 줄 정보 등)
+    const ScriptProgram& getProgram() const {
+        return program;
+    }
+
+    // 파서 초기화
+    void reset() {
+        slotIds.clear();
+        intValues.clear();
+        scopeLevel = 0;
+        currentLine = 0;
+        pc = 0;
+    }
+
+    // 예제 스크립트 가져오기
+    static string getExampleScript(int index) {
+        switch (index) {
+        case 0:
+            return
+                "// 예제 1: 동적할당 - 메모리 누수\n"
+                "int main() {\n"
+                "    int* ptr = new int;\n"
+                "    return 0;\n"
+                "}";
+
+        case 1:
+            return
+                "// 예제 2: 동적할당 - delete 사용\n"
+                "int main() {\n"
+                "    int* ptr = new int;\n"
+                "    delete ptr;\n"
+                "    return 0;\n"
+                "}";
+
+        case 2:
+            return
+                "// 예제 3: Stack vs Heap\n"
+                "int main() {\n"
+                "    int stackVar = 5;\n"
+                "    int* heapPtr = new int;\n"
+                "    delete heapPtr;\n"
+                "    return 0;\n"
+                "}";
+
+        case 3:
+            return
+                "// 예제 4: 다중 포인터 (Double Pointer)\n"
+                "int main() {\n"
+                "    int* ptr = new int;\n"
+                "    int** dptr = &ptr;\n"
+                "    delete ptr;\n"
+                "    return 0;\n"
+                "}";
+
+        case 4:
+            return
+                "// 예제 5: 포인터 배열\n"
+                "int main() {\n"
+                "    int* arr1 = new int;\n"
+                "    int* arr2 = new int;\n"
+                "    int* arr3 = new int;\n"
+                "    delete arr3;\n"
+                "    delete arr2;\n"
+                "    delete arr1;\n"
+                "    return 0;\n"
+                "}";
+
+        default:
+            return "";
+        }
+    }
+
+    static int getExampleCount() {
+        return 5;
+    }
+};
+
+// ==================== 시간 여행 ====================
+
+// 시간 여행 설정: 체크포인트 간격(이벤트 수)과 최대 개수
+struct TimeTravelSettings {
+    uint64_t checkpointInterval = 256;
+    size_t maxCheckpoints = 64;
+};
+
+// 단계별 실행을 앞뒤로 오가는 세션
+// 일정 이벤트 수마다 관리자와 인터프리터 상태의 체크포인트를 남기고, 임의의 단계는
+// 그 이전의 가장 가까운 체크포인트를 복원한 뒤 앞으로 다시 실행해서 재구성함
+// 체크포인트가 최대 개수를 넘으면 하나 걸러 버리고 간격을 두 배로 늘림
+// (한 단계 뒤로 가는 비용은 간격에 비례하고, 메모리는 최대 개수로 제한됨)
+class TimeTravelSession {
+private:
+    struct Checkpoint {
+        size_t step;
+        MemoryManager::Checkpoint memory;
+        ScriptParser::RunState run;
+    };
+
+    MemoryManager& memManager;
+    ScriptParser& parser;
+    vector<Checkpoint> checkpoints;     // step 오름차순
+    uint64_t interval;
+    size_t maxCheckpoints;
+
+    size_t current = 0;     // 현재 단계 (이 단계의 줄은 아직 실행 전)
+    size_t furthest = 0;    // 실제로 실행해 본 가장 먼 단계 (트레이스는 그 뒤부터만 기록)
+    size_t lastStep = UNKNOWN_STEP;
+    bool failed = false;
+
+    void takeCheckpoint() {
+        checkpoints.emplace_back();
+        Checkpoint& checkpoint = checkpoints.back();
+        checkpoint.step = current;
+        memManager.saveCheckpoint(checkpoint.memory);
+        parser.saveState(checkpoint.run);
+
+        if (checkpoints.size() > maxCheckpoints) {
+            size_t kept = 0;
+            for (size_t i = 0; i < checkpoints.size(); i += 2) {
+                if (kept != i) checkpoints[kept] = move(checkpoints[i]);
+                kept++;
+            }
+            checkpoints.resize(kept);
+            interval *= 2;
+        }
+    }
+
+    // 현재 단계의 줄을 실행하고 다음 단계로
+    bool advance() {
+        memManager.setTraceSuspended(current < furthest);
+        bool ok = parser.executeStep();
+        memManager.setTraceSuspended(false);
+        if (!ok) {
+            failed = true;
+            return false;
+        }
+
+        current++;
+        if (current > furthest) furthest = current;
+        if (parser.isFinished()) lastStep = current;
+
+        const Checkpoint& last = checkpoints.back();
+        if (current > last.step &&
+            memManager.getEvents().totalCount() - last.memory.eventCount >= interval) {
+            takeCheckpoint();
+        }
+        return true;
+    }
+
+public:
+    static constexpr size_t UNKNOWN_STEP = SIZE_MAX;
+
+    TimeTravelSession(MemoryManager& manager, ScriptParser& scriptParser, const TimeTravelSettings& settings)
+        : memManager(manager), parser(scriptParser),
+        interval(max<uint64_t>(1, settings.checkpointInterval)),
+        maxCheckpoints(max<size_t>(2, settings.maxCheckpoints)) {
+    }
+
+    // 컴파일된 스크립트를 처음부터 시작
+    void start() {
+        parser.beginRun();
+        checkpoints.clear();
+        current = 0;
+        furthest = 0;
+        lastStep = parser.hasFixedStepCount() ? parser.getLineCount() : UNKNOWN_STEP;
+        failed = false;
+        takeCheckpoint();
+    }
+
+    size_t getStep() const { return current; }
+    // 마지막 단계(프로그램 종료 직전) 번호, 반복문이 있으면 끝까지 가 보기 전에는 UNKNOWN_STEP
+    size_t getLastStep() const { return lastStep; }
+    bool isAtEnd() const { return parser.isFinished(); }
+    bool hasFailed() const { return failed; }
+    size_t getCheckpointCount() const { return checkpoints.size(); }
+
+    bool stepForward() {
+        if (failed || isAtEnd()) return false;
+        return advance();
+    }
+
+    bool stepBack() {
+        if (current == 0) return false;
+        return goTo(current - 1);
+    }
+
+    // 임의의 단계로 이동 (마지막 단계를 넘으면 마지막 단계로)
+    bool goTo(size_t target) {
+        if (failed) return false;
+        if (target > lastStep) target = lastStep;
+
+        if (target < current) {
+            auto it = upper_bound(checkpoints.begin(), checkpoints.end(), target,
+                [](size_t step, const Checkpoint& checkpoint) { return step < checkpoint.step; });
+            const Checkpoint& checkpoint = *(it - 1);
+            memManager.restoreCheckpoint(checkpoint.memory);
+            parser.restoreState(checkpoint.run);
+            current = checkpoint.step;
+        }
+
+        while (current < target && !isAtEnd()) {
+            if (!advance()) return false;
+        }
+        return true;
+    }
+};
+
+// ==================== 자동 재생 ====================
+
+// 자동 재생 설정 (fps가 0이면 단계마다 Enter를 기다림)
+struct AutoplaySettings {
+    int fps = 0;
+    double stepsPerSecond = 0;   // 0이면 실행 속도 제한 없음
+
+    bool enabled() const { return fps > 0; }
+};
+
+// 줄 단위 버퍼링 없이 키를 바로 읽음 (소멸 시 터미널 모드 복원)
+// 표준 입력이 터미널이 아니면 키 입력은 무시됨
+class KeyReader {
+private:
+#ifdef _WIN32
+    bool console = _isatty(_fileno(stdin)) != 0;
+#else
+    termios saved{};
+    bool raw = false;
+#endif
+
+public:
+    KeyReader() {
+#ifndef _WIN32
+        if (!isatty(STDIN_FILENO) || tcgetattr(STDIN_FILENO, &saved) != 0) return;
+        termios mode = saved;
+        mode.c_lflag &= ~(ICANON | ECHO);
+        mode.c_cc[VMIN] = 0;
+        mode.c_cc[VTIME] = 0;
+        raw = tcsetattr(STDIN_FILENO, TCSANOW, &mode) == 0;
+#endif
+    }
+
+    ~KeyReader() {
+#ifndef _WIN32
+        if (raw) tcsetattr(STDIN_FILENO, TCSANOW, &saved);
+#endif
+    }
+
+    KeyReader(const KeyReader&) = delete;
+    KeyReader& operator=(const KeyReader&) = delete;
+
+    // 최대 timeoutMs 동안 키를 기다림, 입력이 없으면 0
+    int poll(int timeoutMs) {
+#ifdef _WIN32
+        auto deadline = chrono::steady_clock::now() + chrono::milliseconds(timeoutMs);
+        while (console) {
+            if (_kbhit()) return _getch();
+            if (chrono::steady_clock::now() >= deadline) return 0;
+            this_thread::sleep_for(chrono::milliseconds(1));
+        }
+#else
+        if (raw) {
+            fd_set readable;
+            FD_ZERO(&readable);
+            FD_SET(STDIN_FILENO, &readable);
+            timeval timeout{ timeoutMs / 1000, (timeoutMs % 1000) * 1000 };
+            unsigned char key = 0;
+            if (select(STDIN_FILENO + 1, &readable, nullptr, nullptr, &timeout) > 0 &&
+                read(STDIN_FILENO, &key, 1) == 1) {
+                return key;
+            }
+            return 0;
+        }
+#endif
+        if (timeoutMs > 0) this_thread::sleep_for(chrono::milliseconds(timeoutMs));
+        return 0;
+    }
+};
+
+// 자동 재생 진행기
+// 스크립트는 최대 속도(또는 지정한 초당 단계 수)로 실행하고, 화면은 목표 fps 간격마다
+// 그 시점의 최신 상태만 그림. 실행이 화면보다 빠르면 중간 프레임은 건너뜀
+// 프레임 구성은 상태가 바뀌지 않게 단계 콜백 안에서 하지만(프레임 간격마다 그 시간만큼 실행이 멈춤),
+// 터미널 쓰기는 쓰기 스레드가 맡으므로 느린 터미널이 실행을 붙잡지 않음
+// 키: [Space] 일시정지/재생, [N] 한 단계, [Q] 끝까지 화면 없이 실행 (키는 건너뛰는 단계에서도 일정 간격으로 확인)
+class AutoplayController {
+private:
+    using Clock = chrono::steady_clock;
+
+    Visualizer& visualizer;
+    const MemoryManager& memManager;
+    AutoplaySettings settings;
+    KeyReader keys;
+
+    Clock::duration frameInterval;
+    Clock::duration stepInterval;
+    Clock::time_point nextFrame;
+    Clock::time_point nextStep;
+    Clock::time_point nextKeyPoll;
+
+    // 키 확인 간격 (매 단계 확인하면 시스템 호출이 실행 속도를 잡아먹음)
+    static constexpr chrono::milliseconds KEY_POLL_INTERVAL{ 10 };
+
+    bool paused = false;
+    bool fastForward = false;
+    bool finished = false;
+    uint64_t skippedFrames = 0;
+    string footer;
+
+    int frameMs() const {
+        return max(1, (int)chrono::duration_cast<chrono::milliseconds>(frameInterval).count());
+    }
+
+    void handleKey(int key) {
+        switch (key) {
+        case ' ':
+        case 'p':
+        case 'P':
+            paused = !paused;
+            break;
+        case 'q':
+        case 'Q':
+            fastForward = true;
+            paused = false;
+            break;
+        default:
+            break;
+        }
+    }
+
+    void render(string_view line, int lineNumber) {
+        footer.clear();
+        if (finished) {
+            footer = "■ 자동 재생 완료 (건너뛴 프레임 " + to_string(skippedFrames) + ")";
+        }
+        else if (paused) {
+            footer = "⏸ 일시정지  [Space] 재생  [N] 한 단계  [Q] 끝까지";
+        }
+        else {
+            footer = "▶ 자동 재생 " + to_string(settings.fps) + "fps (건너뛴 프레임 " +
+                to_string(skippedFrames) + ")  [Space] 일시정지  [Q] 끝까지";
+        }
+        visualizer.printMemoryStateWithLine(memManager, line, lineNumber, footer);
+    }
+
+public:
+    AutoplayController(Visualizer& visualizer, const MemoryManager& memManager, const AutoplaySettings& settings)
+        : visualizer(visualizer), memManager(memManager), settings(settings),
+        frameInterval(chrono::duration_cast<Clock::duration>(chrono::duration<double>(1.0 / settings.fps))),
+        stepInterval(settings.stepsPerSecond > 0
+            ? chrono::duration_cast<Clock::duration>(chrono::duration<double>(1.0 / settings.stepsPerSecond))
+            : Clock::duration::zero()),
+        nextFrame(Clock::now()), nextStep(Clock::now()), nextKeyPoll(Clock::now()) {
+        visualizer.setAsyncOutput(true);
+    }
+
+    ~AutoplayController() { visualizer.setAsyncOutput(false); }
+
+    AutoplayController(const AutoplayController&) = delete;
+    AutoplayController& operator=(const AutoplayController&) = delete;
+
+    // 실행이 끝난 뒤 최종 상태를 한 번 그림 (마지막 단계들이 프레임 간격 안이라 건너뛰었어도)
+    void finish(string_view line, int lineNumber) {
+        finished = true;
+        paused = false;
+        render(line, lineNumber);
+        visualizer.setAsyncOutput(false);
+    }
+
+    // executeScriptStepByStep의 단계 콜백
+    void onStep(string_view line, int lineNumber) {
+        if (fastForward) return;
+
+        // 초당 단계 수 제한: 다음 단계 시각까지 기다리는 동안에도 키는 프레임 간격으로 확인
+        if (stepInterval > Clock::duration::zero()) {
+            while (!paused && !fastForward) {
+                auto now = Clock::now();
+                if (now >= nextStep) break;
+                auto wait = min(nextStep - now, frameInterval);
+                handleKey(keys.poll(max(1, (int)chrono::duration_cast<chrono::milliseconds>(wait).count())));
+            }
+            nextStep = max(nextStep + stepInterval, Clock::now());
+            if (fastForward) return;
+        }
+
+        auto now = Clock::now();
+        if (now >= nextKeyPoll) {
+            handleKey(keys.poll(0));
+            nextKeyPoll = now + KEY_POLL_INTERVAL;
+            if (fastForward) return;
+        }
+        if (!paused && now < nextFrame) {
+            skippedFrames++;
+            return;
+        }
+
+        render(line, lineNumber);
+        // 화면 출력이 늦어져도 밀린 프레임을 몰아서 그리지 않음
+        nextFrame = max(nextFrame + frameInterval, now);
+
+        // 일시정지 중에는 이 단계 앞에서 대기, [N]이면 이 단계만 실행하고 다음 단계에서 다시 멈춤
+        while (paused && !fastForward) {
+            int key = keys.poll(frameMs());
+            if (key == 'n' || key == 'N') break;
+            handleKey(key);
+            if (!paused && !fastForward) render(line, lineNumber);
+        }
+    }
+};
+
+// 단계별 실행 설정
+struct StepSettings {
+    AutoplaySettings autoplay;
+    TimeTravelSettings timeTravel;
+};
+
+// Enter로 한 단계씩 진행하면서 뒤로 가기/단계 이동을 지원하는 실행
+// 명령: Enter 다음 단계, b 이전 단계, g N N번째 단계로 이동, i 이름 변수/블록의 기록 조회
+bool runInteractiveSteps(const string& script, MemoryManager& memManager, ScriptParser& parser,
+    Visualizer& visualizer, const TimeTravelSettings& settings) {
+    parser.compile(script);
+    TimeTravelSession session(memManager, parser, settings);
+    session.start();
+
+    string command;
+    while (true) {
+        size_t step = session.getStep();
+        size_t last = session.getLastStep();
+        string footer = "▶ Enter: 다음 단계  b: 이전 단계  g N: N단계로 이동  i 이름: 기록  (단계 " +
+            to_string(step + 1) + "/" + (last == TimeTravelSession::UNKNOWN_STEP ? "?" : to_string(last + 1)) + ")";
+        if (!session.isAtEnd()) {
+            const ScriptLine& line = parser.getCurrentLine();
+            visualizer.printMemoryStateWithLine(memManager, line.text, line.lineNumber, footer);
+        }
+        else {
+            visualizer.printMemoryStateWithLine(memManager, ScriptParser::EXIT_STEP_TEXT,
+                parser.getExitLineNumber(), footer);
+        }
+
+        if (!getline(cin, command)) command.clear();
+
+        if (command == "b" || command == "B") {
+            session.stepBack();
+        }
+        else if (command.size() > 2 && (command[0] == 'i' || command[0] == 'I') && command[1] == ' ') {
+            size_t begin = command.find_first_not_of(' ', 1);
+            size_t end = command.find_last_not_of(' ');
+            cout << '\n';
+            memManager.printBlockHistory(cout, string_view(command).substr(begin, end + 1 - begin));
+            cout << "\nEnter를 누르면 돌아갑니다...";
+            cout.flush();
+            getline(cin, command);
+            visualizer.invalidateFrame();
+        }
+        else if (!command.empty() && (command[0] == 'g' || command[0] == 'G')) {
+            size_t target = strtoul(command.c_str() + 1, nullptr, 10);
+            session.goTo(target > 0 ? target - 1 : 0);
+        }
+        else if (session.isAtEnd()) {
+            parser.finishRun();
+            return true;
+        }
+        else if (!session.stepForward()) {
+            return false;
+        }
+    }
+}
+
+// 스크립트를 단계별로 실행 (자동 재생이 켜져 있으면 키 입력 없이 진행)
+bool runStepByStep(const string& script, MemoryManager& memManager, ScriptParser& parser,
+    Visualizer& visualizer, const StepSettings& settings) {
+    visualizer.invalidateFrame();
+
+    bool result;
+    if (settings.autoplay.enabled()) {
+        AutoplayController player(visualizer, memManager, settings.autoplay);
+        result = parser.executeScriptStepByStep(script,
+            [&player](string_view line, int lineNum) {
+                player.onStep(line, lineNum);
+            });
+        player.finish(ScriptParser::EXIT_STEP_TEXT, parser.getExitLineNumber());
+    }
+    else {
+        result = runInteractiveSteps(script, memManager, parser, visualizer, settings.timeTravel);
+    }
+    memManager.syncTrace();
+    return result;
+}
+
+// ==================== 메인 함수 ====================
+
+// 메인 메뉴 출력
+void displayMenu(const MemoryManager& memManager) {
+    bool reachability = memManager.getLeakMode() == LeakMode::REACHABILITY;
+    cout << "\n+-- 메뉴 ---------------------------+" << endl;
+    cout << "| 1. 예제 스크립트 단계별 실행      |" << endl;
+    cout << "| 2. 직접 코드 단계별 실행          |" << endl;
+    cout << "| 3. 누수 감지 모드 변경            |" << endl;
+    cout << "|    (현재: " << (reachability ? "도달성 분석" : "직접 참조  ") << ")            |" << endl;
+    cout << "| 4. 트레이스 파일 재생             |" << endl;
+    cout << "| 0. 종료                           |" << endl;
+    cout << "+-----------------------------------+" << endl;
+    cout << "선택: ";
+}
+
+// 예제 목록 출력
+void displayExamples() {
+    cout << "\n예제 스크립트:" << endl;
+    for (int i = 0; i < ScriptParser::getExampleCount(); i++) {
+        cout << "  " << (i + 1) << ". ";
+        string script = ScriptParser::getExampleScript(i);
+        size_t newline = script.find('\n');
+        if (newline != string::npos) {
+            cout << script.substr(3, newline - 3);
+        }
+        cout << endl;
+    }
+    cout << "  0. 돌아가기" << endl;
+    cout << "선택: ";
+}
+
+
+// 예제 스크립트를 단계별로 실행
+void runExampleStepByStep(int index, MemoryManager& memManager, ScriptParser& parser, Visualizer& visualizer,
+    const StepSettings& settings) {
+    parser.reset();
+    memManager.reset();
+
+    string script = ScriptParser::getExampleScript(index);
+
+    cout << "\n" << "=== 스크립트 (단계별 실행) ===" << endl;
+    cout << script << endl;
+    cout << "===============================" << endl;
+
+    cout << "\n 단계별 실행 모드" << endl;
+    cout << "각 줄이 실행될 때마다 메모리 변화를 확인할 수 있습니다." << endl;
+    cout << "\n아무 키나 누르면 시작합니다...";
+    cin.ignore(numeric_limits<streamsize>::max(), '\n');
+    cin.get();
+
+    bool result = runStepByStep(script, memManager, parser, visualizer, settings);
+
+    if (!result) {
+        cout << "\n[ERROR] 스크립트 실행 실패! " << parser.getLastError() << endl;
+        cout << "\n아무 키나 누르면 계속...";
+        cin.get();
+    }
+    else {
+        visualizer.clearScreen();
+        cout << "\n" << "프로그램 실행 완료!" << endl;
+        cout << "\n최종 메모리 상태:" << endl << endl;
+
+        const auto& leaks = memManager.getLeaks();
+        if (!leaks.empty()) {
+            cout << "\033[1;31m";
+            cout << "!! 메모리 누수 감지 !! " << leaks.size() << "개 블록" << "\033[0m" << endl;
+            for (int id : leaks) {
+                MemoryBlock block = memManager.findBlock(id);
+                if (block) {
+                    cout << "  - \033[31m" << block.name() << " (" << block.size() << " bytes)\033[0m" << endl;
+                }
+            }
+            cout << endl;
+        }
+        else {
+            cout << "\033[32m[OK] 메모리 누수가 없습니다!\033[0m" << endl << endl;
+        }
+
+        visualizer.printMemoryState(memManager);
+
+        cout << "\n아무 키나 누르면 계속...";
+        cin.get();
+    }
+}
+
+// 사용자가 직접 입력한 코드를 단계별로 실행
+void runCustomCode(MemoryManager& memManager, ScriptParser& parser, Visualizer& visualizer,
+    const StepSettings& settings) {
+    parser.reset();
+    memManager.reset();
+
+    cout << "\n┌─────────────────────────────────────────────────┐" << endl;
+    cout << "  코드를 입력하세요 (입력 완료 후 빈 줄에서 Enter)" << endl;
+    cout << "└─────────────────────────────────────────────────┘" << endl;
+    cout << "\n예시:\n";
+    cout << "int main() {\n";
+    cout << "    int x = 5;\n";
+    cout << "    int* ptr = new int;\n";
+    cout << "    delete ptr;\n";
+    cout << "    return 0;\n";
+    cout << "}\n" << endl;
+    cout << "입력 시작 (빈 줄에서 Enter로 종료):\n" << endl;
+
+    string code;
+    string line;
+
+    cin.ignore(numeric_limits<streamsize>::max(), '\n');
+
+    int lineCount = 0;
+    while (true) {
+        cout << (lineCount + 1) << ": ";
+        getline(cin, line);
+
+        if (line.empty()) {
+            cout << "[DEBUG] 입력 종료 (총 " << lineCount << "줄)" << endl;
+            break;
+        }
+
+        code += line + "\n";
+        lineCount++;
+    }
+
+    if (code.empty()) {
+        cout << "\n[ERROR] 코드가 입력되지 않았습니다." << endl;
+        cout << "아무 키나 누르면 계속...";
+        cin.get();
+        return;
+    }
+
+    cout << "\n[DEBUG] 입력된 코드:\n" << code << endl;
+
+    cout << "\n⭐ 단계별 실행 시작" << endl;
+    cout << "각 줄이 실행될 때마다 메모리 변화를 확인할 수 있습니다." << endl;
+    cout << "\n아무 키나 누르면 시작합니다...";
+    cin.get();
+
+    bool result = runStepByStep(code, memManager, parser, visualizer, settings);
+
+    if (!result) {
+        cout << "\n[ERROR] 스크립트 실행 실패! " << parser.getLastError() << endl;
+        cout << "\n아무 키나 누르면 계속...";
+        cin.get();
+    }
+    else {
+        visualizer.clearScreen();
+        cout << "\n" << " 프로그램 실행 완료!" << endl;
+        cout << "\n최종 메모리 상태:" << endl << endl;
+
+        const auto& leaks = memManager.getLeaks();
+        if (!leaks.empty()) {
+            cout << "\033[1;31m";
+            cout << " 메모리 누수 감지! " << leaks.size() << "개 블록" << "\033[0m" << endl;
+            for (int id : leaks) {
+                MemoryBlock block = memManager.findBlock(id);
+                if (block) {
+                    cout << "  - \033[31m" << block.name() << " (" << block.size() << " bytes)\033[0m" << endl;
+                }
+            }
+            cout << endl;
+        }
+        else {
+            cout << "\033[32m[OK] 메모리 누수가 없습니다!\033[0m" << endl << endl;
+        }
+
+        visualizer.printMemoryState(memManager);
+
+        cout << "\n아무 키나 누르면 계속...";
+        cin.get();
+    }
+}
+
+// 트레이스 파일을 읽어 원하는 이벤트 시점의 메모리 상태 재구성
+void runTraceReplay(Visualizer& visualizer) {
+    cout << "\n트레이스 파일 경로: ";
+    string path;
+    cin.ignore(numeric_limits<streamsize>::max(), '\n');
+    getline(cin, path);
+
+    TraceReader reader;
+    if (!reader.open(path)) {
+        cout << "\n[ERROR] 트레이스 파일을 열 수 없습니다: " << path << endl;
+        cout << "아무 키나 누르면 계속...";
         cin.get();
+        return;
+    }
+
+    cout << "이벤트 " << reader.eventCount() << "개"
+        << (reader.isComplete() ? "" : " (종료 레코드 없음 - 순차 탐색으로 복구)") << endl;
+    if (reader.sessionCount() > 1) {
+        cout << "세션 " << reader.sessionCount() << "개 (시작 이벤트:";
+        for (size_t i = 0; i < reader.sessionCount(); i++) cout << ' ' << reader.sessionStart(i);
+        cout << ") - 세션 경계를 지나면 빈 상태에서 다시 재생" << endl;
+    }
+    cout << "재생할 이벤트 수 (빈 줄이면 전체): ";
+    string countLine;
+    getline(cin, countLine);
+    uint64_t count = reader.eventCount();
+    if (!countLine.empty()) count = strtoull(countLine.c_str(), nullptr, 10);
+
+    // 재생 중인 세션이 기록 중인 트레이스를 덮어쓰지 않도록 별도 관리자 사용
+    MemoryManager replayManager;
+    reader.replay(replayManager, count);
+    visualizer.printMemoryState(replayManager);
+
+    cout << "\n아무 키나 누르면 계속...";
+    cin.get();
+}
+
+// JSON 문자열 값 출력 (따옴표와 제어 문자 이스케이프)
+void writeJsonString(ostream& out, string_view text) {
+    out << '"';
+    for (char ch : text) {
+        switch (ch) {
+        case '"': out << "\\\""; break;
+        case '\\': out << "\\\\"; break;
+        case '\n': out << "\\n"; break;
+        case '\r': out << "\\r"; break;
+        case '\t': out << "\\t"; break;
+        default:
+            if ((unsigned char)ch < 0x20) {
+                char escaped[8];
+                snprintf(escaped, sizeof(escaped), "\\u%04x", (unsigned char)ch);
+                out << escaped;
+            }
+            else {
+                out << ch;
+            }
+        }
+    }
+    out << '"';
+}
+
+// 메모리 통계를 "stats" 객체 필드로 출력 (앞에 쉼표 포함)
+void writeStatsJson(ostream& out, const MemoryStats& stats) {
+    auto writeHistogram = [&](const uint64_t* counts) {
+        out << '[';
+        for (int i = 0; i < MemoryStats::SIZE_CLASS_COUNT; i++) {
+            if (i > 0) out << ',';
+            out << counts[i];
+        }
+        out << ']';
+    };
+
+    out << ",\"stats\":{\"stackBytes\":" << stats.stackBytes
+        << ",\"stackBlocks\":" << stats.stackBlocks
+        << ",\"heapBytes\":" << stats.heapBytes
+        << ",\"heapBlocks\":" << stats.heapBlocks
+        << ",\"peakStackBytes\":" << stats.peakStackBytes
+        << ",\"peakStackBlocks\":" << stats.peakStackBlocks
+        << ",\"peakHeapBytes\":" << stats.peakHeapBytes
+        << ",\"peakHeapBlocks\":" << stats.peakHeapBlocks
+        << ",\"heapExtent\":" << stats.heapExtent;
+    // 모델 힙이 없으면 단편화는 알 수 없으므로 null
+    if (stats.simulatedHeap) {
+        out << ",\"externalFragmentation\":" << stats.externalFragmentation()
+            << ",\"internalFragmentation\":" << stats.internalFragmentation();
+    }
+    else {
+        out << ",\"externalFragmentation\":null,\"internalFragmentation\":null";
+    }
+    out << ",\"sizeClassLimits\":[";
+    for (int i = 0; i < MemoryStats::SIZE_CLASS_COUNT - 1; i++) {
+        if (i > 0) out << ',';
+        out << MemoryStats::sizeClassLimit(i);
+    }
+    out << "],\"liveBySize\":";
+    writeHistogram(stats.liveBySize);
+    out << ",\"allocatedBySize\":";
+    writeHistogram(stats.allocatedBySize);
+    out << '}';
+}
+
+// 스크립트 파일 전체 읽기 ("-"이면 표준 입력)
+bool readScriptFile(const string& path, string& out) {
+    ostringstream buffer;
+    if (path == "-") {
+        buffer << cin.rdbuf();
+    }
+    else {
+        ifstream file(path, ios::binary);
+        if (!file) return false;
+        buffer << file.rdbuf();
+    }
+    out = buffer.str();
+    return true;
+}
+
+// 배치 목록에 "-"가 있으면 표준 입력을 한 번만 읽어 둠
+// (작업마다 읽으면 병렬 워커들이 cin을 동시에 읽고, 두 번째 "-"부터는 빈 스크립트가 됨)
+bool readBatchStdin(const vector<string>& paths, string& out) {
+    if (find(paths.begin(), paths.end(), "-") == paths.end()) return false;
+    return readScriptFile("-", out);
+}
+
+// 배치 실행 결과 한 건
+struct BatchResult {
+    string script;
+    bool loaded = false;
+    bool ok = false;
+    // 실행 실패 이유 (ok가 false일 때)
+    string error;
+    size_t leaks = 0;
+    uint64_t leakedBytes = 0;
+    uint64_t peakBytes = 0;
+    size_t blocks = 0;
+    uint64_t events = 0;
+    uint64_t heapFootprint = 0;
+    MemoryStats stats;
+    double elapsedMs = 0;
+};
+
+// 스크립트 하나를 화면 출력 없이 실행하고 요약 수집
+// reuseBlocks가 false면 해제된 블록도 끝까지 남겨 두므로 --inspect로 조회할 수 있음
+// stdinScript: 미리 읽어 둔 표준 입력 ("-" 경로에 사용, 없으면 그 자리에서 읽음)
+BatchResult runBatchScript(const string& path, MemoryManager& memManager, ScriptParser& parser,
+    bool reuseBlocks = true, const string* stdinScript = nullptr) {
+    BatchResult result;
+    result.script = path;
+
+    string script;
+    if (path == "-" && stdinScript) script = *stdinScript;
+    else if (!readScriptFile(path, script)) return result;
+    result.loaded = true;
+
+    auto start = chrono::steady_clock::now();
+    parser.reset();
+    memManager.reset();
+    // 배치에서는 해제된 블록을 다시 조회하지 않으므로 slot을 재사용 (반복문이 블록을 계속 만들어도 저장소가 커지지 않음)
+    memManager.setBlockReuse(reuseBlocks);
+    result.ok = parser.executeScriptStepByStep(script, nullptr);
+    if (!result.ok) result.error = parser.getLastError();
+    auto end = chrono::steady_clock::now();
+
+    result.leaks = memManager.getLeakCount();
+    result.leakedBytes = memManager.getLeakedBytes();
+    result.peakBytes = memManager.getPeakBytes();
+    result.blocks = memManager.getBlockCount();
+    result.events = memManager.getEvents().totalCount();
+    result.heapFootprint = memManager.getHeapFootprint();
+    result.stats = memManager.getStats();
+    result.elapsedMs = chrono::duration<double, milli>(end - start).count();
+    return result;
+}
+
+// 결과를 JSON 한 줄로 출력
+void printBatchResult(ostream& out, const BatchResult& result) {
+    out << "{\"script\":";
+    writeJsonString(out, result.script);
+    if (!result.loaded) {
+        out << ",\"ok\":false,\"error\":\"cannot read file\"}\n";
+        return;
+    }
+    out << ",\"ok\":" << (result.ok ? "true" : "false");
+    if (!result.ok) {
+        out << ",\"error\":";
+        writeJsonString(out, result.error);
+    }
+    out << ",\"leaks\":" << result.leaks
+        << ",\"leakedBytes\":" << result.leakedBytes
+        << ",\"peakBytes\":" << result.peakBytes
+        << ",\"blocks\":" << result.blocks
+        << ",\"events\":" << result.events
+        << ",\"heapFootprint\":" << result.heapFootprint;
+    writeStatsJson(out, result.stats);
+    out << ",\"elapsedMs\":" << result.elapsedMs
+        << "}\n";
+}
+
+// 실패한 스크립트의 이유를 표준 에러로
+void reportBatchFailure(const BatchResult& result) {
+    if (!result.loaded) cerr << "[ERROR] " << result.script << ": 파일을 읽을 수 없습니다" << endl;
+    else if (!result.ok) cerr << "[ERROR] " << result.script << ": " << result.error << endl;
+}
+
+// --inspect로 지정한 블록들의 기록 출력 (결과 JSON 줄 뒤에 텍스트로)
+void printInspections(ostream& out, const MemoryManager& memManager, const vector<string>& queries) {
+    for (const auto& query : queries) {
+        memManager.printBlockHistory(out, query);
+    }
+}
+
+// 헤드리스 배치 모드: 프롬프트나 화면 지우기 없이 스크립트들을 차례로 실행
+// 읽을 수 없거나 실행에 실패한 스크립트가 있으면 종료 코드 1
+int runBatch(const vector<string>& paths, MemoryManager& memManager, ScriptParser& parser,
+    const vector<string>& inspect = {}) {
+    int exitCode = 0;
+    string stdinScript;
+    bool hasStdin = readBatchStdin(paths, stdinScript);
+    for (const auto& path : paths) {
+        BatchResult result = runBatchScript(path, memManager, parser, inspect.empty(),
+            hasStdin ? &stdinScript : nullptr);
+        printBatchResult(cout, result);
+        reportBatchFailure(result);
+        if (result.loaded) printInspections(cout, memManager, inspect);
+        if (!result.loaded || !result.ok) exitCode = 1;
+    }
+    cout.flush();
+    return exitCode;
+}
+
+// ==================== 병렬 배치 실행 ====================
+
+// 작업 훔치기 스레드 풀
+// 작업 인덱스를 워커별 덱에 연속 구간으로 나눠 담고, 각 워커는 자기 덱 앞에서 꺼냄
+// 자기 덱이 비면 다른 워커 덱의 뒤쪽에서 훔쳐 오므로 작업 길이가 고르지 않아도 균형이 맞음
+class WorkStealingPool {
+private:
+    struct WorkerQueue {
+        mutex lock;
+        deque<size_t> jobs;
+    };
+
+    static bool popLocal(WorkerQueue& queue, size_t& job) {
+        lock_guard<mutex> guard(queue.lock);
+        if (queue.jobs.empty()) return false;
+        job = queue.jobs.front();
+        queue.jobs.pop_front();
+        return true;
+    }
+
+    static bool steal(WorkerQueue& queue, size_t& job) {
+        lock_guard<mutex> guard(queue.lock);
+        if (queue.jobs.empty()) return false;
+        job = queue.jobs.back();
+        queue.jobs.pop_back();
+        return true;
+    }
+
+public:
+    // jobCount개 작업을 workerCount개 스레드로 실행, task(워커 번호, 작업 번호)
+    static void run(size_t jobCount, size_t workerCount,
+        const function<void(size_t, size_t)>& task) {
+        if (workerCount == 0) workerCount = 1;
+        if (workerCount > jobCount) workerCount = jobCount > 0 ? jobCount : 1;
+
+        vector<unique_ptr<WorkerQueue>> queues;
+        for (size_t w = 0; w < workerCount; w++) {
+            queues.push_back(make_unique<WorkerQueue>());
+        }
+        for (size_t job = 0; job < jobCount; job++) {
+            queues[job * workerCount / (jobCount ? jobCount : 1)]->jobs.push_back(job);
+        }
+
+        atomic<size_t> remaining(jobCount);
+        auto worker = [&](size_t self) {
+            size_t job;
+            while (remaining.load(memory_order_acquire) > 0) {
+                bool found = popLocal(*queues[self], job);
+                for (size_t i = 1; !found && i < workerCount; i++) {
+                    found = steal(*queues[(self + i) % workerCount], job);
+                }
+                if (!found) break;
+                task(self, job);
+                remaining.fetch_sub(1, memory_order_release);
+            }
+        };
+
+        vector<thread> threads;
+        for (size_t w = 1; w < workerCount; w++) {
+            threads.emplace_back(worker, w);
+        }
+        worker(0);
+        for (auto& t : threads) t.join();
+    }
+};
+
+// 워커 하나가 소유하는 관리자/파서 쌍 (작업 사이에 reset으로 재사용해 용량 유지)
+struct BatchWorker {
+    MemoryManager memManager;
+    ScriptParser parser;
+
+    BatchWorker() : parser(memManager) {}
+};
+
+// 여러 스크립트를 병렬로 실행하고 결과는 입력 순서대로 출력
+// 앞선 결과가 모두 끝난 시점마다 이어서 출력하므로 파이프라인에서도 바로 흘러나감
+int runParallelBatch(const vector<string>& paths, size_t jobs, AllocatorKind allocatorKind) {
+    size_t workerCount = min(jobs == 0 ? (size_t)1 : jobs, max(paths.size(), (size_t)1));
+    vector<unique_ptr<BatchWorker>> workers;
+    for (size_t w = 0; w < workerCount; w++) {
+        workers.push_back(make_unique<BatchWorker>());
+        workers.back()->memManager.setAllocator(allocatorKind);
+    }
+
+    // 표준 입력은 워커를 띄우기 전에 여기서 한 번만 읽고 내용을 공유
+    string stdinScript;
+    bool hasStdin = readBatchStdin(paths, stdinScript);
+
+    vector<BatchResult> results(paths.size());
+    vector<char> finished(paths.size(), 0);
+    size_t nextToPrint = 0;
+    mutex printLock;
+    int exitCode = 0;
+
+    WorkStealingPool::run(paths.size(), workerCount, [&](size_t w, size_t job) {
+        BatchWorker& worker = *workers[w];
+        results[job] = runBatchScript(paths[job], worker.memManager, worker.parser, true,
+            hasStdin ? &stdinScript : nullptr);
+
+        lock_guard<mutex> guard(printLock);
+        finished[job] = 1;
+        while (nextToPrint < paths.size() && finished[nextToPrint]) {
+            const BatchResult& result = results[nextToPrint];
+            printBatchResult(cout, result);
+            reportBatchFailure(result);
+            if (!result.loaded || !result.ok) exitCode = 1;
+            results[nextToPrint] = BatchResult();
+            nextToPrint++;
+        }
+    });
+
+    cout.flush();
+    return exitCode;
+}
+
+// 스크립트 경로 목록 파일 읽기 (한 줄에 하나, 빈 줄 무시)
+bool readScriptList(const string& path, vector<string>& out) {
+    ifstream file(path);
+    if (!file) return false;
+    string line;
+    while (getline(file, line)) {
+        if (!line.empty() && line.back() == '\r') line.pop_back();
+        if (!line.empty()) out.push_back(line);
+    }
+    return true;
+}
+
+// ==================== 주소 단위 추적 ====================
+
+// 주소 단위 할당/해제를 MemoryManager 블록으로 옮김 (실제 프로그램 추적과 외부 트레이스 가져오기 공용)
+// 블록 이름은 할당 종류나 호출 위치
+// 포인터 관계를 모르므로 누수는 이벤트로 남지 않고, 보고 시점에 아직 살아있는 블록이 누수로 집계됨
+class AddressTracker {
+private:
+    MemoryManager& memManager;
+    // 실제 주소 -> 살아있는 블록 ID
+    AddressMap liveBlocks;
+    bool simulate;
+
+public:
+    uint64_t allocations = 0;
+    uint64_t frees = 0;
+    // 추적 시작 전에 할당된 블록의 해제 등 대응하는 할당이 없는 해제
+    uint64_t unknownFrees = 0;
+
+    // simulateAddresses: 트레이스의 주소는 블록을 찾는 키로만 쓰고, 블록 주소는 할당자 모델이 정함
+    // (같은 트레이스로 할당자 전략을 비교할 때)
+    AddressTracker(MemoryManager& manager, bool simulateAddresses = false)
+        : memManager(manager), simulate(simulateAddresses) {}
+
+    size_t getLiveCount() const { return liveBlocks.size(); }
+    uint64_t getRecordCount() const { return allocations + frees + unknownFrees; }
+
+    void allocate(string_view name, uint64_t address, uint64_t size) {
+        if (address == 0) return;
+        // 같은 주소가 아직 살아있다면 그 해제를 놓친 것이므로 먼저 해제
+        int previous = liveBlocks.erase(address);
+        if (previous != -1) memManager.deallocate(previous);
+        int id = simulate ? memManager.allocateHeap(name, (size_t)size)
+            : memManager.allocateHeap(name, (size_t)size, (void*)(uintptr_t)address);
+        liveBlocks.insert(address, id);
+        allocations++;
+    }
+
+    void release(uint64_t address) {
+        int id = liveBlocks.erase(address);
+        if (id == -1) {
+            unknownFrees++;
+            return;
+        }
+        memManager.deallocate(id);
+        frees++;
+    }
+};
+
+// 주소 추적 요약 필드 (실제 프로그램 추적과 가져오기 결과 JSON 공용)
+void printTrackerFields(ostream& out, const AddressTracker& tracker, const MemoryManager& memManager) {
+    out << ",\"allocations\":" << tracker.allocations
+        << ",\"frees\":" << tracker.frees
+        << ",\"unknownFrees\":" << tracker.unknownFrees
+        << ",\"leaks\":" << memManager.getLeakCount()
+        << ",\"leakedBytes\":" << memManager.getLeakedBytes()
+        << ",\"peakBytes\":" << memManager.getPeakBytes()
+        << ",\"blocks\":" << memManager.getBlockCount()
+        << ",\"events\":" << memManager.getEvents().totalCount();
+    writeStatsJson(out, memManager.getStats());
+}
+
+// ==================== 실제 프로그램 추적 ====================
+
+// 할당 가로채기 라이브러리(memviz_preload.cpp)가 보낸 이벤트 스트림을 적용
+// 스레드별 링에서 모인 레코드는 스레드 간 순서가 섞여 도착하므로 seq 순서로 다시 맞춘 뒤 적용함
+// (seq는 빈틈없이 증가하므로 다음 순번이 올 때까지만 최소 힙에 보관)
+class PreloadConsumer {
+private:
+    AddressTracker& tracker;
+
+    struct LaterSeq {
+        bool operator()(const PreloadEvent& a, const PreloadEvent& b) const { return a.seq > b.seq; }
+    };
+    vector<PreloadEvent> pending;
+    uint64_t nextSeq = 0;
+
+    // 받은 바이트가 레코드 경계에서 끊겼을 때의 앞부분 (헤더 포함)
+    char partial[sizeof(PreloadEvent)];
+    size_t partialSize = 0;
+    bool headerRead = false;
+
+public:
+    // 종료 중이라 전달되지 못한 순번
+    uint64_t missingEvents = 0;
+
+private:
+    static string_view opName(PreloadOp op) {
+        switch (op) {
+        case PreloadOp::MALLOC: return "malloc";
+        case PreloadOp::CALLOC: return "calloc";
+        case PreloadOp::REALLOC: return "realloc";
+        case PreloadOp::ALIGNED: return "aligned_alloc";
+        case PreloadOp::NEW: return "new";
+        case PreloadOp::NEW_ARRAY: return "new[]";
+        default: return "";
+        }
+    }
+
+    void apply(const PreloadEvent& event) {
+        if (event.address == 0) return;
+        if (isReleaseOp(event.op())) tracker.release(event.address);
+        else tracker.allocate(opName(event.op()), event.address, event.size());
+    }
+
+    void accept(const PreloadEvent& event) {
+        if (event.seq != nextSeq) {
+            pending.push_back(event);
+            push_heap(pending.begin(), pending.end(), LaterSeq());
+            return;
+        }
+        apply(event);
+        nextSeq++;
+        while (!pending.empty() && pending.front().seq == nextSeq) {
+            pop_heap(pending.begin(), pending.end(), LaterSeq());
+            apply(pending.back());
+            pending.pop_back();
+            nextSeq++;
+        }
+    }
+
+    bool readHeader(const char* data, string& error) {
+        PreloadStreamHeader header;
+        memcpy(&header, data, sizeof(header));
+        if (memcmp(header.magic, PRELOAD_MAGIC, sizeof(header.magic)) != 0) {
+            error = "MVPL 스트림이 아닙니다 (시작 표시가 다름)";
+            return false;
+        }
+        if (header.version != PRELOAD_VERSION || header.recordSize != sizeof(PreloadEvent)) {
+            error = "지원하지 않는 MVPL 스트림입니다 (버전 " + to_string(header.version) + ", 레코드 " +
+                to_string(header.recordSize) + "바이트; 지원: 버전 " + to_string(PRELOAD_VERSION) +
+                ", 레코드 " + to_string(sizeof(PreloadEvent)) + "바이트)";
+            return false;
+        }
+        headerRead = true;
+        return true;
+    }
+
+    // 헤더 또는 레코드 하나 (partial에 모인 것)
+    bool acceptWhole(const char* data, string& error) {
+        if (!headerRead) return readHeader(data, error);
+        PreloadEvent event;
+        memcpy(&event, data, sizeof(event));
+        accept(event);
+        return true;
+    }
+
+public:
+    explicit PreloadConsumer(AddressTracker& addressTracker) : tracker(addressTracker) {}
+
+    // 받은 바이트를 이어서 적용 (레코드 경계와 무관하게 잘라 넘겨도 됨), 형식이 맞지 않으면 false
+    bool feed(const char* data, size_t size, string& error) {
+        while (size > 0) {
+            size_t need = headerRead ? sizeof(PreloadEvent) : sizeof(PreloadStreamHeader);
+            if (partialSize > 0 || size < need) {
+                size_t take = min(need - partialSize, size);
+                memcpy(partial + partialSize, data, take);
+                partialSize += take;
+                data += take;
+                size -= take;
+                if (partialSize < need) return true;
+                partialSize = 0;
+                if (!acceptWhole(partial, error)) return false;
+                continue;
+            }
+            if (!headerRead) {
+                if (!readHeader(data, error)) return false;
+                data += need;
+                size -= need;
+                continue;
+            }
+
+            size_t records = size / sizeof(PreloadEvent);
+            for (size_t i = 0; i < records; i++) {
+                PreloadEvent event;
+                memcpy(&event, data + i * sizeof(PreloadEvent), sizeof(event));
+                accept(event);
+            }
+            data += records * sizeof(PreloadEvent);
+            size -= records * sizeof(PreloadEvent);
+        }
+        return true;
+    }
+
+    // 스트림 끝: 남은 레코드는 빈 순번을 건너뛰고 순서대로 적용
+    bool finish(string& error) {
+        while (!pending.empty()) {
+            pop_heap(pending.begin(), pending.end(), LaterSeq());
+            const PreloadEvent& event = pending.back();
+            missingEvents += event.seq - nextSeq;
+            apply(event);
+            nextSeq = event.seq + 1;
+            pending.pop_back();
+        }
+        if (!headerRead) {
+            error = partialSize > 0
+                ? "MVPL 헤더가 잘렸습니다 (" + to_string(sizeof(PreloadStreamHeader)) + "바이트 중 " +
+                    to_string(partialSize) + "바이트)"
+                : "no allocation stream received";
+            return false;
+        }
+        return true;
+    }
+
+#ifndef _WIN32
+    // 파일 디스크립터에서 스트림을 끝까지 읽어 적용
+    bool consume(int fd, string& error) {
+        vector<char> buffer(256 * 1024);
+        while (true) {
+            ssize_t received = read(fd, buffer.data(), buffer.size());
+            if (received < 0) {
+                if (errno == EINTR) continue;
+                error = strerror(errno);
+                return false;
+            }
+            if (received == 0) break;
+            if (!feed(buffer.data(), (size_t)received, error)) return false;
+        }
+        return finish(error);
+    }
+#endif
+};
+
+// 추적 결과를 배치 모드와 같은 JSON 한 줄로 출력
+void printPreloadResult(ostream& out, string_view program, int exitCode, const AddressTracker& tracker,
+    const PreloadConsumer& consumer, const MemoryManager& memManager, double elapsedMs) {
+    out << "{\"program\":";
+    writeJsonString(out, program);
+    out << ",\"exitCode\":" << exitCode;
+    printTrackerFields(out, tracker, memManager);
+    out << ",\"missingEvents\":" << consumer.missingEvents
+        << ",\"elapsedMs\":" << elapsedMs
+        << "}\n";
+}
+
+#ifndef _WIN32
+// 가로채기 라이브러리 경로: 지정값 > MEMVIZ_PRELOAD > 실행 파일과 같은 디렉터리
+string findPreloadLibrary(const string& requested) {
+    string path = requested;
+    if (path.empty()) {
+        if (const char* env = getenv("MEMVIZ_PRELOAD")) path = env;
+    }
+    if (path.empty()) {
+        char self[4096];
+        ssize_t length = readlink("/proc/self/exe", self, sizeof(self) - 1);
+        string dir = ".";
+        if (length > 0) {
+            string exe(self, (size_t)length);
+            size_t slash = exe.rfind('/');
+            if (slash != string::npos) dir = exe.substr(0, slash);
+        }
+        path = dir + "/libmemviz_preload.so";
+    }
+    // LD_PRELOAD는 대상 프로그램의 작업 디렉터리 기준으로 해석되므로 절대 경로로 바꿈
+    char resolved[4096];
+    if (!realpath(path.c_str(), resolved)) return "";
+    return resolved;
+}
+
+// 프로그램을 가로채기 라이브러리와 함께 실행하고 할당을 파이프로 받아 적용
+// 대상 프로그램의 종료 코드를 그대로 반환 (추적 실패 시 1)
+int runPreloadExec(const vector<string>& command, const string& requestedLibrary, MemoryManager& memManager) {
+    string library = findPreloadLibrary(requestedLibrary);
+    if (library.empty()) {
+        cerr << "가로채기 라이브러리를 찾을 수 없습니다 (--preload-lib 또는 MEMVIZ_PRELOAD로 지정)" << endl;
+        return 1;
+    }
+
+    int fds[2];
+    if (pipe(fds) != 0) {
+        cerr << "파이프를 만들 수 없습니다: " << strerror(errno) << endl;
+        return 1;
+    }
+    fcntl(fds[0], F_SETFD, FD_CLOEXEC);
+
+    auto start = chrono::steady_clock::now();
+    pid_t child = fork();
+    if (child < 0) {
+        cerr << "프로세스를 만들 수 없습니다: " << strerror(errno) << endl;
+        close(fds[0]);
+        close(fds[1]);
+        return 1;
+    }
+    if (child == 0) {
+        close(fds[0]);
+        string preload = library;
+        if (const char* existing = getenv("LD_PRELOAD")) {
+            if (*existing) preload += string(":") + existing;
+        }
+        setenv("LD_PRELOAD", preload.c_str(), 1);
+        setenv(PRELOAD_FD_ENV, to_string(fds[1]).c_str(), 1);
+
+        vector<char*> argv;
+        for (const auto& arg : command) argv.push_back(const_cast<char*>(arg.c_str()));
+        argv.push_back(nullptr);
+        execvp(argv[0], argv.data());
+        fprintf(stderr, "실행할 수 없습니다: %s: %s\n", argv[0], strerror(errno));
+        _exit(127);
+    }
+    close(fds[1]);
+
+    memManager.setBlockReuse(true);
+    AddressTracker tracker(memManager);
+    PreloadConsumer consumer(tracker);
+    string error;
+    bool consumed = consumer.consume(fds[0], error);
+    close(fds[0]);
+
+    int status = 0;
+    while (waitpid(child, &status, 0) < 0 && errno == EINTR) {}
+    int exitCode = WIFEXITED(status) ? WEXITSTATUS(status) : 128 + WTERMSIG(status);
+    auto end = chrono::steady_clock::now();
+
+    if (!consumed) {
+        cerr << "할당 스트림을 읽지 못했습니다: " << error << endl;
+        return exitCode != 0 ? exitCode : 1;
+    }
+    printPreloadResult(cout, command[0], exitCode, tracker, consumer, memManager,
+        chrono::duration<double, milli>(end - start).count());
+    cout.flush();
+    return exitCode;
+}
+
+// 따로 실행된 프로그램(MEMVIZ_PATH=<FIFO>)의 스트림을 FIFO에서 받아 적용
+int runPreloadAttach(const string& path, MemoryManager& memManager) {
+    int fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        cerr << "스트림을 열 수 없습니다: " << path << ": " << strerror(errno) << endl;
+        return 1;
+    }
+    auto start = chrono::steady_clock::now();
+    memManager.setBlockReuse(true);
+    AddressTracker tracker(memManager);
+    PreloadConsumer consumer(tracker);
+    string error;
+    bool consumed = consumer.consume(fd, error);
+    close(fd);
+    auto end = chrono::steady_clock::now();
+
+    if (!consumed) {
+        cerr << "할당 스트림을 읽지 못했습니다: " << error << endl;
+        return 1;
+    }
+    printPreloadResult(cout, path, 0, tracker, consumer, memManager, chrono::duration<double, milli>(end - start).count());
+    cout.flush();
+    return 0;
+}
+#endif
+// ==================== 외부 트레이스 가져오기 ====================
+
+// 파일을 두 버퍼에 번갈아 읽는 읽기 스레드 (한 버퍼를 해석하는 동안 다른 버퍼를 채움)
+class DoubleBufferedReader {
+private:
+    FILE* file;
+    vector<char> buffers[2];
+    size_t filled[2] = { 0, 0 };
+    // 채워져 해석을 기다리는 버퍼
+    bool ready[2] = { false, false };
+    // 해석 중인 버퍼 (-1: 없음)
+    int current = -1;
+    // 다음에 넘겨줄 버퍼 (읽기 스레드와 같은 순서로 번갈아감)
+    int expected = 0;
+    bool finished = false;
+    bool stopRequested = false;
+    // 읽기 실패 시 읽기 스레드에서 잡아 둔 errno (0: 실패 없음, errno는 스레드마다 따로라 해석 스레드에서는 볼 수 없음)
+    int errorNumber = 0;
+    mutex lock;
+    condition_variable changed;
+    thread worker;
+
+    void readLoop() {
+        for (int index = 0;; index ^= 1) {
+            {
+                unique_lock<mutex> guard(lock);
+                changed.wait(guard, [&] { return stopRequested || (!ready[index] && current != index); });
+                if (stopRequested) return;
+            }
+            vector<char>& buffer = buffers[index];
+            errno = 0;
+            size_t got = fread(buffer.data(), 1, buffer.size(), file);
+            bool end = got < buffer.size();
+            int readError = end && ferror(file) ? (errno != 0 ? errno : EIO) : 0;
+            {
+                lock_guard<mutex> guard(lock);
+                filled[index] = got;
+                ready[index] = got > 0;
+                if (end) {
+                    finished = true;
+                    errorNumber = readError;
+                }
+            }
+            changed.notify_all();
+            if (end) return;
+        }
+    }
+
+public:
+    DoubleBufferedReader(FILE* input, size_t bufferBytes) : file(input) {
+        buffers[0].resize(bufferBytes);
+        buffers[1].resize(bufferBytes);
+        worker = thread(&DoubleBufferedReader::readLoop, this);
+    }
+
+    ~DoubleBufferedReader() {
+        {
+            lock_guard<mutex> guard(lock);
+            stopRequested = true;
+        }
+        changed.notify_all();
+        worker.join();
+    }
+
+    DoubleBufferedReader(const DoubleBufferedReader&) = delete;
+    DoubleBufferedReader& operator=(const DoubleBufferedReader&) = delete;
+
+    // 다음 버퍼 (이전에 받은 버퍼는 읽기 스레드에 돌려줌), 끝이면 false
+    bool next(const char*& data, size_t& size) {
+        unique_lock<mutex> guard(lock);
+        if (current != -1) {
+            ready[current] = false;
+            current = -1;
+            changed.notify_all();
+        }
+        changed.wait(guard, [&] { return ready[expected] || finished; });
+        if (!ready[expected]) return false;
+        current = expected;
+        expected ^= 1;
+        data = buffers[current].data();
+        size = filled[current];
+        return true;
+    }
+
+    // 읽기 실패의 errno (실패하지 않았으면 0)
+    int errorCode() {
+        lock_guard<mutex> guard(lock);
+        return errorNumber;
+    }
+};
+
+// 텍스트 트레이스 해석 (공백 구분, 한 줄에 레코드 하나, #으로 시작하면 주석)
+//   alloc <주소> <크기> [호출 위치]
+//   free <주소>
+//   realloc <이전 주소> <새 주소> <크기> [호출 위치]
+// 종류는 첫 글자로 구분 (a/m/c/n: 할당, f/d: 해제, r: realloc)하므로 malloc, new[], delete 등도 그대로 읽힘
+// 주소와 크기는 10진수, 0x로 시작하면 16진수. 호출 위치가 없으면 종류 이름이 블록 이름이 됨
+class TextTraceParser {
+private:
+    AddressTracker& tracker;
+    // 버퍼 경계에 걸친 줄의 앞부분
+    string carry;
+
+    static const char* skipSpaces(const char* p, const char* end) {
+        while (p < end && (*p == ' ' || *p == '\t')) p++;
+        return p;
     }
-}
 
-// 사용자가 직접 입력한 코드를 단계별로 실행
-void runCustomCode(MemoryManager& memManager, ScriptParser& parser, Visualizer& visualizer) {
-    parser.reset();
-    memManager.reset();
+    static bool parseNumber(const char*& p, const char* end, uint64_t& value) {
+        p = skipSpaces(p, end);
+        int base = 10;
+        if (end - p > 2 && p[0] == '0' && (p[1] == 'x' || p[1] == 'X')) {
+            p += 2;
+            base = 16;
+        }
+        from_chars_result result = from_chars(p, end, value, base);
+        if (result.ec != errc()) return false;
+        p = result.ptr;
+        return true;
+    }
 
-    cout << "\n┌─────────────────────────────────────────────────┐" << endl;
-    cout << "  코드를 입력하세요 (입력 완료 후 빈 줄에서 Enter)" << endl;
-    cout << "└─────────────────────────────────────────────────┘" << endl;
-    cout << "\n예시:\n";
-    cout << "int main() {\n";
-    cout << "    int x = 5;\n";
-    cout << "    int* ptr = new int;\n";
-    cout << "    delete ptr;\n";
-    cout << "    return 0;\n";
-    cout << "}\n" << endl;
-    cout << "입력 시작 (빈 줄에서 Enter로 종료):\n" << endl;
+    // 줄의 나머지 (앞뒤 공백 제외), 비어 있으면 fallback
+    static string_view siteOr(const char* p, const char* end, string_view fallback) {
+        p = skipSpaces(p, end);
+        while (end > p && (end[-1] == ' ' || end[-1] == '\t')) end--;
+        return p < end ? string_view(p, end - p) : fallback;
+    }
 
-    string code;
-    string line;
+    void parseLine(const char* p, const char* end) {
+        if (end > p && end[-1] == '\r') end--;
+        p = skipSpaces(p, end);
+        if (p == end || *p == '#') return;
+
+        const char* word = p;
+        while (p < end && *p != ' ' && *p != '\t') p++;
+        string_view op(word, p - word);
+
+        uint64_t address = 0;
+        uint64_t newAddress = 0;
+        uint64_t size = 0;
+        switch (op[0]) {
+        case 'a': case 'm': case 'c': case 'n':
+            if (!parseNumber(p, end, address) || !parseNumber(p, end, size)) break;
+            tracker.allocate(siteOr(p, end, op), address, size);
+            return;
+        case 'f': case 'd':
+            if (!parseNumber(p, end, address)) break;
+            tracker.release(address);
+            return;
+        case 'r':
+            if (!parseNumber(p, end, address) || !parseNumber(p, end, newAddress) || !parseNumber(p, end, size)) break;
+            // realloc(NULL, n)은 할당만, 실패(새 주소 0)는 원래 블록이 그대로 남음
+            if (newAddress == 0) return;
+            if (address != 0) tracker.release(address);
+            tracker.allocate(siteOr(p, end, op), newAddress, size);
+            return;
+        }
+        malformedLines++;
+    }
 
-    cin.ignore(numeric_limits<streamsize>::max(), '\n');
+public:
+    uint64_t malformedLines = 0;
+
+    explicit TextTraceParser(AddressTracker& addressTracker) : tracker(addressTracker) {}
+
+    void feed(const char* data, size_t size) {
+        MEMVIZ_PROFILE_SCOPE("TextTraceParser::feed");
+        const char* end = data + size;
+        if (!carry.empty()) {
+            const char* newline = (const char*)memchr(data, '\n', size);
+            if (newline == nullptr) {
+                carry.append(data, size);
+                return;
+            }
+            carry.append(data, newline - data);
+            parseLine(carry.data(), carry.data() + carry.size());
+            carry.clear();
+            data = newline + 1;
+        }
+        while (data < end) {
+            const char* newline = (const char*)memchr(data, '\n', end - data);
+            if (newline == nullptr) {
+                carry.assign(data, end - data);
+                return;
+            }
+            parseLine(data, newline);
+            data = newline + 1;
+        }
+    }
 
-    int lineCount = 0;
-    while (true) {
-        cout << (lineCount + 1) << ": ";
-        getline(cin, line);
+    // 마지막 줄에 줄바꿈이 없는 경우
+    void finish() {
+        if (!carry.empty()) parseLine(carry.data(), carry.data() + carry.size());
+        carry.clear();
+    }
+};
 
-        if (line.empty()) {
-            cout << "[DEBUG] 입력 종료 (총 " << lineCount << "줄)" << endl;
-            break;
+// 가져오기 진행 표시 (표준 에러가 터미널일 때만, 0.2초마다 같은 줄을 덮어씀)
+class ImportProgress {
+private:
+    using Clock = chrono::steady_clock;
+
+    uint64_t totalBytes;
+    bool enabled;
+    uint64_t bytes = 0;
+    Clock::time_point start = Clock::now();
+    Clock::time_point lastPrint = start;
+
+    void print(uint64_t records) {
+        double seconds = chrono::duration<double>(Clock::now() - start).count();
+        double rate = seconds > 0 ? records / seconds / 1e6 : 0;
+        if (totalBytes > 0) {
+            fprintf(stderr, "\r가져오는 중 %5.1f%%  %.1f MB  %.2fM 레코드  %.1fM/초 ",
+                bytes * 100.0 / totalBytes, bytes / 1048576.0, records / 1e6, rate);
+        }
+        else {
+            fprintf(stderr, "\r가져오는 중 %.1f MB  %.2fM 레코드  %.1fM/초 ",
+                bytes / 1048576.0, records / 1e6, rate);
         }
+        fflush(stderr);
+    }
 
-        code += line + "\n";
-        lineCount++;
+public:
+    // totalBytes가 0이면 (파이프 등) 백분율 없이 표시
+    ImportProgress(uint64_t total, bool show) : totalBytes(total), enabled(show) {}
+
+    void update(size_t chunkBytes, uint64_t records) {
+        bytes += chunkBytes;
+        if (!enabled) return;
+        Clock::time_point now = Clock::now();
+        if (now - lastPrint < chrono::milliseconds(200)) return;
+        lastPrint = now;
+        print(records);
     }
 
-    if (code.empty()) {
-        cout << "\n[ERROR] 코드가 입력되지 않았습니다." << endl;
-        cout << "아무 키나 누르면 계속...";
-        cin.get();
-        return;
+    uint64_t getBytes() const { return bytes; }
+
+    void finish(uint64_t records) {
+        if (!enabled) return;
+        print(records);
+        fputc('\n', stderr);
     }
+};
 
-    cout << "\n[DEBUG] 입력된 코드:\n" << code << endl;
+// 트레이스 앞부분으로 형식 판별: "MVPL"로 시작하면 바이너리, 제어 문자가 없으면 텍스트
+// 판별할 수 없으면 (잘린 "MVPL" 또는 텍스트가 아닌 바이트) false와 이유
+bool detectTraceFormat(string_view head, bool& binary, string& error) {
+    size_t magicSize = sizeof(PRELOAD_MAGIC);
+    if (head.size() >= magicSize && memcmp(head.data(), PRELOAD_MAGIC, magicSize) == 0) {
+        binary = true;
+        return true;
+    }
+    if (head.size() < magicSize && !head.empty() && memcmp(head.data(), PRELOAD_MAGIC, head.size()) == 0) {
+        error = "MVPL 헤더가 잘렸습니다 (" + to_string(head.size()) + "바이트)";
+        return false;
+    }
+    for (unsigned char c : head) {
+        if (c < 0x20 && c != '\t' && c != '\n' && c != '\r') {
+            error = "알 수 없는 형식입니다 (MVPL 헤더도 텍스트 트레이스도 아님)";
+            return false;
+        }
+    }
+    binary = false;
+    return true;
+}
 
-    cout << "\n⭐ 단계별 실행 시작" << endl;
-    cout << "각 줄이 실행될 때마다 메모리 변화를 확인할 수 있습니다." << endl;
-    cout << "\n아무 키나 누르면 시작합니다...";
-    cin.get();
+// 외부 할당자가 남긴 트레이스(텍스트 또는 가로채기 라이브러리의 바이너리 스트림)를 전부 읽지 않고
+// 버퍼 단위로 흘려보내며 적용. 형식은 앞부분(바이너리 헤더 크기만큼)을 모아 판별
+// simulateAddresses면 블록 주소를 할당자 모델이 정하고 결과에 모델 힙 크기를 함께 출력
+int runImport(const string& path, MemoryManager& memManager, bool simulateAddresses,
+    const vector<string>& inspect = {}) {
+    bool fromStdin = path == "-";
+    FILE* file = fromStdin ? stdin : fopen(path.c_str(), "rb");
+    if (file == nullptr) {
+        cerr << "트레이스 파일을 열 수 없습니다: " << path << endl;
+        return 1;
+    }
+    uint64_t totalBytes = 0;
+    if (!fromStdin) {
+        ifstream sizeProbe(path, ios::binary | ios::ate);
+        streamoff end = sizeProbe.tellg();
+        if (end > 0) totalBytes = (uint64_t)end;
+    }
+    // 읽기 스레드가 버퍼로 직접 읽도록 stdio 버퍼링을 끔
+    setvbuf(file, nullptr, _IONBF, 0);
+
+    // 블록 수가 레코드 수만큼 늘지 않도록 해제된 블록을 재사용 (--inspect가 있으면 해제된 블록도 조회하도록 끔)
+    memManager.setBlockReuse(inspect.empty());
+    AddressTracker tracker(memManager, simulateAddresses);
+    PreloadConsumer binaryStream(tracker);
+    TextTraceParser textStream(tracker);
+    ImportProgress progress(totalBytes, stderrIsTerminal());
+
+    auto started = chrono::steady_clock::now();
+    bool detected = false;
+    bool binary = false;
+    bool ok = true;
+    string error;
+    // 형식 판별 전에 모은 앞부분 (읽기 단위가 헤더보다 짧게 끊겨 와도 판별할 수 있게)
+    string head;
+    auto feedChunk = [&](const char* data, size_t size) {
+        if (binary) return binaryStream.feed(data, size, error);
+        textStream.feed(data, size);
+        return true;
+    };
+    {
+        DoubleBufferedReader reader(file, 1 << 20);
+        const char* data;
+        size_t size;
+        while (reader.next(data, size)) {
+            size_t chunkBytes = size;
+            if (!detected) {
+                size_t take = min(size, sizeof(PreloadStreamHeader) - head.size());
+                head.append(data, take);
+                data += take;
+                size -= take;
+                if (head.size() < sizeof(PreloadStreamHeader)) {
+                    progress.update(chunkBytes, 0);
+                    continue;
+                }
+                detected = true;
+                ok = detectTraceFormat(head, binary, error) && feedChunk(head.data(), head.size());
+                if (!ok) break;
+            }
+            if (!feedChunk(data, size)) {
+                ok = false;
+                break;
+            }
+            progress.update(chunkBytes, tracker.getRecordCount());
+        }
+        int readError = reader.errorCode();
+        if (ok && readError != 0) {
+            error = strerror(readError);
+            ok = false;
+        }
+    }
+    if (!fromStdin) fclose(file);
 
-    bool result = parser.executeScriptStepByStep(code,
-        [&memManager, &visualizer](const string& line, int lineNum) {
-            visualizer.printMemoryStateWithLine(memManager, line, lineNum);
-            cin.get();
-        });
+    // 헤더보다 짧은 트레이스 (몇 줄짜리 텍스트 또는 잘린 바이너리)
+    if (ok && !detected && !head.empty()) {
+        ok = detectTraceFormat(head, binary, error) && feedChunk(head.data(), head.size());
+    }
 
-    if (!result) {
-        cout << "\n[ERROR] 스크립트 실행 실패!" << endl;
-        cout << "\n아무 키나 누르면 계속...";
-        cin.get();
+    if (ok) {
+        if (binary) ok = binaryStream.finish(error);
+        else textStream.finish();
+    }
+    progress.finish(tracker.getRecordCount());
+    if (!ok) {
+        cerr << "트레이스를 가져오지 못했습니다: " << error << endl;
+        return 1;
     }
-    else {
-        visualizer.clearScreen();
-        cout << "\n" << " 프로그램 실행 완료!" << endl;
-        cout << "\n최종 메모리 상태:" << endl << endl;
 
-        auto leaks = memManager.detectLeaks();
-        if (!leaks.empty()) {
-            cout << "\033[1;31m";
-            cout << " 메모리 누수 감지! " << leaks.size() << "개 블록" << "\033[0m" << endl;
-            for (int id : leaks) {
-                const MemoryBlock* block = memManager.findBlock(id);
-                if (block) {
-                    cout << "  - \033[31m" << block->name << " (" << block->size << " bytes)\033[0m" << endl;
+    double elapsedMs = chrono::duration<double, milli>(chrono::steady_clock::now() - started).count();
+    uint64_t records = tracker.getRecordCount();
+    cout << "{\"trace\":";
+    writeJsonString(cout, path);
+    cout << ",\"format\":\"" << (binary ? "binary" : "text") << "\""
+        << ",\"bytes\":" << progress.getBytes()
+        << ",\"records\":" << records;
+    printTrackerFields(cout, tracker, memManager);
+    if (binary) cout << ",\"missingEvents\":" << binaryStream.missingEvents;
+    else cout << ",\"malformedLines\":" << textStream.malformedLines;
+    if (simulateAddresses) {
+        cout << ",\"allocator\":\"" << allocatorKindName(memManager.getAllocatorKind()) << "\""
+            << ",\"heapFootprint\":" << memManager.getHeapFootprint()
+            << ",\"failedAllocations\":" << memManager.getFailedAllocations();
+        if (memManager.getFailedAllocations() > 0) {
+            cerr << "[WARN] 할당자 모델 힙(최대 1TB)에 공간이 없어 주소 없이 만든 블록: "
+                << memManager.getFailedAllocations() << "개" << endl;
+        }
+    }
+    cout << ",\"elapsedMs\":" << elapsedMs
+        << ",\"recordsPerSec\":" << (uint64_t)(elapsedMs > 0 ? records * 1000.0 / elapsedMs : 0)
+        << "}\n";
+    printInspections(cout, memManager, inspect);
+    return 0;
+}
+
+
+// ==================== 작업량 생성기 ====================
+
+// 시드 고정 난수 (splitmix64). 표준 분포 클래스는 구현마다 결과가 달라서 쓰지 않고
+// 정수 연산만으로 뽑으므로 같은 시드면 어느 플랫폼에서도 같은 수열이 나옴
+class SplitMix64 {
+private:
+    uint64_t state;
+
+public:
+    explicit SplitMix64(uint64_t seed) : state(seed) {}
+
+    uint64_t next() {
+        uint64_t z = (state += 0x9E3779B97F4A7C15ULL);
+        z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+        z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+        return z ^ (z >> 31);
+    }
+
+    // [0, n) (나머지 연산의 치우침은 n이 작아 무시할 만함)
+    uint64_t below(uint64_t n) { return next() % n; }
+
+    // 확률은 toThreshold로 미리 2^53 척도 정수로 바꿔 둠
+    bool chance(uint64_t threshold) { return (next() >> 11) < threshold; }
+
+    static uint64_t toThreshold(double probability) {
+        return (uint64_t)(min(max(probability, 0.0), 1.0) * 9007199254740992.0);
+    }
+};
+
+enum class WorkloadFormat {
+    SCRIPT,     // ScriptParser 스크립트 (--batch 등으로 실행)
+    TRACE       // --import 텍스트 트레이스
+};
+
+// 생성할 작업량의 모양
+struct WorkloadShape {
+    WorkloadFormat format = WorkloadFormat::SCRIPT;
+    uint64_t seed = 1;
+    uint64_t blocks = 1000;     // 힙 할당 수
+    double freeRatio = 0.8;     // 할당 중 나중에 해제하는 비율
+    double leakRate = 0.05;     // 할당 중 가리키는 포인터를 모두 끊어 누수시키는 비율 (나머지는 끝까지 살아 있음)
+    int chainDepth = 2;         // 블록마다 포인터의 포인터 사슬 깊이 상한 (0~N 균등)
+    int fanIn = 3;              // 한 블록을 함께 가리키는 별칭 포인터 수 상한
+    double aliasRate = 0.2;     // 별칭 포인터를 두는 블록 비율
+    int scopeDepth = 3;         // { } 중첩 깊이 상한
+    uint64_t live = 1024;       // 동시에 살아 있는 블록 수 상한 (생성기 메모리도 이만큼만 씀)
+};
+
+// 시드와 모양만으로 정해지는 스크립트/트레이스를 버퍼 단위로 흘려보냄
+// 블록은 할당할 때 운명(해제/누수/유지)을 정하고, 살아 있는 블록을 스코프별로 들고 있다가
+// 상한을 넘거나 임의로 골라 정리함. 스코프를 닫으면 그 안에서 할당된 블록 중 해제할 것만 해제하고
+// 나머지는 포인터가 범위를 벗어나 누수됨 (트레이스에는 스코프 줄이 없지만 수명은 같음)
+class WorkloadGenerator {
+private:
+    enum class Fate : unsigned char { FREE, LEAK, KEEP };
+
+    struct LiveBlock {
+        uint64_t id;
+        uint64_t address;   // 트레이스용 주소
+        uint64_t size;
+        uint16_t aliases;
+        unsigned char type;
+        bool array;
+        Fate fate;
+    };
+
+    struct ScalarType {
+        const char* name;
+        uint64_t size;
+    };
+
+    static constexpr ScalarType TYPES[] = {
+        { "int", 4 }, { "double", 8 }, { "char", 1 }, { "long", 8 }, { "short", 2 }, { "float", 4 }
+    };
+    static constexpr size_t FLUSH_SIZE = 1 << 16;
+    static constexpr int MAX_ARRAY = 64;
+
+    const WorkloadShape& shape;
+    ostream& out;
+    SplitMix64 rng;
+    string buffer;
+    vector<vector<LiveBlock>> scopes;   // [0]은 main 본문
+    uint64_t liveCount = 0;
+    uint64_t nextAddress = 0x10000000;
+
+    uint64_t freeThreshold;
+    uint64_t leakThreshold;
+    uint64_t aliasThreshold;
+
+    void put(string_view text) { buffer.append(text.data(), text.size()); }
+
+    void put(uint64_t value) {
+        char digits[24];
+        auto result = to_chars(digits, digits + sizeof(digits), value);
+        buffer.append(digits, result.ptr - digits);
+    }
+
+    void putHex(uint64_t value) {
+        char digits[24];
+        auto result = to_chars(digits, digits + sizeof(digits), value, 16);
+        buffer += "0x";
+        buffer.append(digits, result.ptr - digits);
+    }
+
+    bool script() const { return shape.format == WorkloadFormat::SCRIPT; }
+
+    void beginLine() {
+        if (script()) buffer.append(4 * scopes.size(), ' ');
+    }
+
+    void endLine() {
+        buffer += '\n';
+        lines++;
+        if (buffer.size() >= FLUSH_SIZE) flush();
+    }
+
+    void flush() {
+        out.write(buffer.data(), (streamsize)buffer.size());
+        buffer.clear();
+    }
+
+    void putName(char prefix, uint64_t id) {
+        buffer += prefix;
+        put(id);
+    }
+
+    void allocate(uint64_t id) {
+        LiveBlock block{};
+        block.id = id;
+        block.type = (unsigned char)rng.below(size(TYPES));
+        block.array = rng.below(4) == 0;
+        uint64_t count = block.array ? 1 + rng.below(MAX_ARRAY) : 1;
+        const ScalarType& type = TYPES[block.type];
+        block.size = type.size * count;
+
+        uint64_t roll = rng.next() >> 11;
+        block.fate = roll < leakThreshold ? Fate::LEAK
+            : roll < leakThreshold + freeThreshold ? Fate::FREE : Fate::KEEP;
+
+        if (script()) {
+            // T* pN = new T; / new T[k];
+            beginLine();
+            put(type.name);
+            put("* ");
+            putName('p', id);
+            put(" = new ");
+            put(type.name);
+            if (block.array) {
+                buffer += '[';
+                put(count);
+                buffer += ']';
+            }
+            buffer += ';';
+            endLine();
+
+            // T** pN_1 = &pN; T*** pN_2 = &pN_1; ...
+            uint64_t depth = shape.chainDepth > 0 ? rng.below((uint64_t)shape.chainDepth + 1) : 0;
+            for (uint64_t k = 1; k <= depth; k++) {
+                beginLine();
+                put(type.name);
+                buffer.append(k + 1, '*');
+                buffer += ' ';
+                putName('p', id);
+                buffer += '_';
+                put(k);
+                put(" = &");
+                putName('p', id);
+                if (k > 1) {
+                    buffer += '_';
+                    put(k - 1);
+                }
+                buffer += ';';
+                endLine();
+            }
+
+            // T* aN_j = pN;
+            if (shape.fanIn > 0 && rng.chance(aliasThreshold)) {
+                block.aliases = (uint16_t)(1 + rng.below((uint64_t)shape.fanIn));
+                for (uint64_t j = 0; j < block.aliases; j++) {
+                    beginLine();
+                    put(type.name);
+                    put("* ");
+                    putName('a', id);
+                    buffer += '_';
+                    put(j);
+                    put(" = ");
+                    putName('p', id);
+                    buffer += ';';
+                    endLine();
                 }
             }
-            cout << endl;
         }
         else {
-            cout << "\033[32m[OK] 메모리 누수가 없습니다!\033[0m" << endl << endl;
+            block.address = nextAddress;
+            nextAddress += (block.size + 15) / 16 * 16 + 16;
+            put("malloc ");
+            putHex(block.address);
+            buffer += ' ';
+            put(block.size);
+            put(" gen:");
+            put(type.name);
+            if (block.array) put("[]");
+            endLine();
         }
 
-        visualizer.printMemoryState(memManager);
+        scopes.back().push_back(block);
+        liveCount++;
+    }
 
-        cout << "\n아무 키나 누르면 계속...";
-        cin.get();
+    // 블록의 운명대로 정리 (atScopeExit이면 해제할 것만 해제하고 나머지는 범위를 벗어나 누수)
+    void retire(const LiveBlock& block, bool atScopeExit) {
+        if (block.fate == Fate::FREE) {
+            beginLine();
+            if (script()) {
+                put(block.array ? "delete[] " : "delete ");
+                putName('p', block.id);
+                buffer += ';';
+            }
+            else {
+                put("free ");
+                putHex(block.address);
+            }
+            endLine();
+            freed++;
+        }
+        else if (block.fate == Fate::LEAK && !atScopeExit) {
+            if (script()) {
+                beginLine();
+                putName('p', block.id);
+                put(" = nullptr;");
+                endLine();
+                for (uint64_t j = 0; j < block.aliases; j++) {
+                    beginLine();
+                    putName('a', block.id);
+                    buffer += '_';
+                    put(j);
+                    put(" = nullptr;");
+                    endLine();
+                }
+            }
+            leaked++;
+        }
+        else if (atScopeExit) {
+            leaked++;
+        }
+        else {
+            keptToExit++;
+        }
+    }
+
+    // 살아 있는 블록 중 하나를 골라 정리 (바깥 스코프 이름은 안쪽에서도 보이므로 어느 스코프든 가능)
+    void retireRandom() {
+        uint64_t pick = rng.below(liveCount);
+        for (auto& level : scopes) {
+            if (pick < level.size()) {
+                LiveBlock block = level[pick];
+                level[pick] = level.back();
+                level.pop_back();
+                liveCount--;
+                retire(block, false);
+                return;
+            }
+            pick -= level.size();
+        }
+    }
+
+    void openScope() {
+        beginLine();
+        if (script()) {
+            buffer += '{';
+            endLine();
+        }
+        scopes.emplace_back();
+    }
+
+    void closeScope() {
+        vector<LiveBlock> level = move(scopes.back());
+        scopes.pop_back();
+        liveCount -= level.size();
+        // 닫는 괄호 앞에서 해제하도록 들여쓰기는 안쪽 깊이 기준
+        scopes.emplace_back();
+        for (const auto& block : level) retire(block, true);
+        scopes.pop_back();
+        if (script()) {
+            beginLine();
+            buffer += '}';
+            endLine();
+        }
+    }
+
+public:
+    uint64_t lines = 0;
+    uint64_t freed = 0;
+    uint64_t leaked = 0;
+    uint64_t keptToExit = 0;
+
+    WorkloadGenerator(const WorkloadShape& shape, ostream& out)
+        : shape(shape), out(out), rng(shape.seed),
+        freeThreshold(SplitMix64::toThreshold(shape.freeRatio)),
+        leakThreshold(SplitMix64::toThreshold(shape.leakRate)),
+        aliasThreshold(SplitMix64::toThreshold(shape.aliasRate)) {
+        buffer.reserve(FLUSH_SIZE + 4096);
+    }
+
+    void run() {
+        if (script()) {
+            put("// memviz 생성 스크립트 (seed ");
+            put(shape.seed);
+            put(")");
+            endLine();
+            put("int main() {");
+            endLine();
+        }
+        else {
+            put("# memviz 생성 트레이스 (seed ");
+            put(shape.seed);
+            put(")");
+            endLine();
+        }
+        scopes.emplace_back();
+
+        for (uint64_t id = 0; id < shape.blocks; id++) {
+            uint64_t roll = rng.below(16);
+            if (roll == 0 && (int)scopes.size() <= shape.scopeDepth) openScope();
+            else if (roll == 1 && scopes.size() > 1) closeScope();
+
+            allocate(id);
+            if (liveCount > shape.live) retireRandom();
+            if (rng.below(2) == 0) retireRandom();
+        }
+
+        while (scopes.size() > 1) closeScope();
+        for (const auto& block : scopes.back()) retire(block, false);
+        scopes.back().clear();
+        liveCount = 0;
+
+        if (script()) {
+            put("    return 0;");
+            endLine();
+            buffer += '}';
+            endLine();
+        }
+        flush();
+        out.flush();
+    }
+};
+
+constexpr WorkloadGenerator::ScalarType WorkloadGenerator::TYPES[];
+
+// --generate 옵션 읽기 (args[0]은 형식)
+bool parseWorkloadShape(const vector<string>& args, WorkloadShape& shape, string& outputPath, string& error) {
+    if (args.empty() || (args[0] != "script" && args[0] != "trace")) {
+        error = "형식은 script 또는 trace";
+        return false;
+    }
+    shape.format = args[0] == "script" ? WorkloadFormat::SCRIPT : WorkloadFormat::TRACE;
+
+    for (size_t i = 1; i < args.size(); i++) {
+        const string& arg = args[i];
+        if (i + 1 >= args.size()) {
+            error = "값이 없는 옵션: " + arg;
+            return false;
+        }
+        const char* value = args[++i].c_str();
+        if (arg == "--seed") shape.seed = strtoull(value, nullptr, 10);
+        else if (arg == "--blocks") shape.blocks = strtoull(value, nullptr, 10);
+        else if (arg == "--free-ratio") shape.freeRatio = atof(value);
+        else if (arg == "--leak-rate") shape.leakRate = atof(value);
+        else if (arg == "--chain-depth") shape.chainDepth = atoi(value);
+        else if (arg == "--fan-in") shape.fanIn = atoi(value);
+        else if (arg == "--alias-rate") shape.aliasRate = atof(value);
+        else if (arg == "--scope-depth") shape.scopeDepth = atoi(value);
+        else if (arg == "--live") shape.live = strtoull(value, nullptr, 10);
+        else if (arg == "--output" || arg == "-o") outputPath = value;
+        else {
+            error = "알 수 없는 옵션: " + arg;
+            return false;
+        }
+    }
+
+    if (shape.freeRatio < 0 || shape.leakRate < 0 || shape.freeRatio + shape.leakRate > 1) {
+        error = "--free-ratio와 --leak-rate는 0 이상이고 합이 1 이하여야 함";
+        return false;
     }
+    if (shape.aliasRate < 0 || shape.aliasRate > 1) {
+        error = "--alias-rate는 0~1";
+        return false;
+    }
+    if (shape.chainDepth < 0 || shape.chainDepth > 16 || shape.fanIn < 0 || shape.fanIn > 1024 ||
+        shape.scopeDepth < 0 || shape.scopeDepth > 64 || shape.live == 0) {
+        error = "범위: --chain-depth 0~16, --fan-in 0~1024, --scope-depth 0~64, --live 1 이상";
+        return false;
+    }
+    return true;
+}
+
+// 작업량 생성 (파일로 쓰면 표준 출력에 JSON 요약)
+int runGenerate(const vector<string>& args) {
+    WorkloadShape shape;
+    string outputPath;
+    string error;
+    if (!parseWorkloadShape(args, shape, outputPath, error)) {
+        cerr << "--generate: " << error << endl;
+        return 2;
+    }
+
+    ofstream file;
+    if (!outputPath.empty()) {
+        file.open(outputPath, ios::binary | ios::trunc);
+        if (!file) {
+            cerr << "출력 파일을 열 수 없습니다: " << outputPath << endl;
+            return 1;
+        }
+    }
+    ostream& out = outputPath.empty() ? cout : file;
+
+    auto start = chrono::steady_clock::now();
+    WorkloadGenerator generator(shape, out);
+    generator.run();
+    if (!out) {
+        cerr << "출력을 쓰지 못했습니다" << endl;
+        return 1;
+    }
+
+    if (!outputPath.empty()) {
+        file.close();
+        double elapsedMs = chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+        cout << "{\"output\":";
+        writeJsonString(cout, outputPath);
+        cout << ",\"format\":\"" << (shape.format == WorkloadFormat::SCRIPT ? "script" : "trace") << "\""
+            << ",\"seed\":" << shape.seed
+            << ",\"blocks\":" << shape.blocks
+            << ",\"lines\":" << generator.lines
+            << ",\"freed\":" << generator.freed
+            << ",\"leaked\":" << generator.leaked
+            << ",\"liveAtExit\":" << generator.keptToExit
+            << ",\"elapsedMs\":" << elapsedMs
+            << "}\n";
+    }
+    return 0;
+}
+
+// 사용법 출력
+void printUsage(const char* program) {
+    cout << "사용법: " << program << " [--trace <파일>] [--profile <파일>] [--autoplay] [--fps N] [--speed N]" << endl;
+    cout << "        " << program << " --batch <스크립트>... [--jobs N] [--batch-list <파일>] [--trace <파일>]" << endl;
+    cout << "        " << program << " [--trace <파일>] [--preload-lib <경로>] --exec <프로그램> [인자...]" << endl;
+    cout << "        " << program << " [--trace <파일>] --attach <FIFO>" << endl;
+    cout << "        " << program << " [--trace <파일>] [--allocator <모델>] --import <트레이스 파일>" << endl;
+    cout << "        " << program << " --generate <script|trace> [--seed N] [--blocks N] [생성 옵션...] [--output <파일>]" << endl;
+    cout << "  --batch       스크립트를 대화 없이 실행하고 결과를 JSON 한 줄씩 출력 (- 는 표준 입력)" << endl;
+    cout << "  --batch-list  실행할 스크립트 경로 목록 파일 (한 줄에 하나)" << endl;
+    cout << "  --jobs        병렬 워커 수 (기본: CPU 코어 수, 결과는 입력 순서대로 출력)" << endl;
+    cout << "  --trace       이벤트를 바이너리 트레이스 파일로 기록 (--jobs 1에서만)" << endl;
+    cout << "  --autoplay    단계별 실행을 Enter 없이 자동 재생 ([Space] 일시정지, [N] 한 단계, [Q] 끝까지)" << endl;
+    cout << "  --fps         자동 재생 화면 갱신 목표 (기본 30, 지정하면 자동 재생)" << endl;
+    cout << "  --speed       자동 재생 초당 실행 단계 수 (기본: 제한 없음)" << endl;
+    cout << "  --checkpoint-interval  단계 이동용 체크포인트 간격, 이벤트 수 (기본 256)" << endl;
+    cout << "  --max-checkpoints      보관할 최대 체크포인트 수 (기본 64, 넘으면 간격을 두 배로)" << endl;
+    cout << "  --exec        프로그램을 할당 가로채기 라이브러리와 함께 실행하고 실제 malloc/new를 추적해 JSON 요약 출력" << endl;
+    cout << "  --preload-lib 가로채기 라이브러리 경로 (기본: MEMVIZ_PRELOAD 또는 실행 파일 옆 libmemviz_preload.so)" << endl;
+    cout << "  --attach      MEMVIZ_PATH=<FIFO>로 따로 실행한 프로그램의 할당 스트림을 FIFO에서 받음" << endl;
+    cout << "  --import      외부 할당자의 텍스트/바이너리 트레이스를 스트리밍으로 적용하고 JSON 요약 출력 (- 는 표준 입력)" << endl;
+    cout << "  --allocator   힙 주소 할당자 모델: bump, slab, buddy, first-fit (기본)" << endl;
+    cout << "                --import와 함께 쓰면 트레이스 주소 대신 모델 주소로 배치하고 모델 힙 크기를 출력" << endl;
+    cout << "  --inspect     --batch/--import 후 이름(또는 #ID) 블록의 전체 기록 출력 (여러 번 지정 가능, 단계별 실행에서는 i 이름)" << endl;
+    cout << "  --event-retention  메모리에 남길 최근 이벤트 수 (기본 4096)" << endl;
+    cout << "  --event-spill 링 버퍼에서 밀려나는 이벤트를 이 파일에 보존 (--inspect로 끝까지 조회 가능)" << endl;
+    cout << "  --profile     계측 구간 시간을 Chrome trace JSON 파일로 쓰고 구간별 p50/p99 요약을 표준 에러에 출력" << endl;
+    cout << "                (MEMVIZ_PROFILING=1 빌드에서만, CMake 빌드는 기본 포함)" << endl;
+    cout << "  --generate    시드로 재현되는 스크립트/트레이스를 스트리밍으로 생성 (뒤의 인자는 모두 생성 옵션)" << endl;
+    cout << "                --blocks 할당 수 (기본 1000), --free-ratio 해제 비율 (0.8), --leak-rate 누수 비율 (0.05)," << endl;
+    cout << "                --chain-depth 포인터 사슬 깊이 (2), --fan-in 별칭 포인터 수 (3), --alias-rate 별칭 비율 (0.2)," << endl;
+    cout << "                --scope-depth 스코프 중첩 깊이 (3), --live 동시에 살아 있는 블록 수 (1024)" << endl;
 }
 
 // 프로그램 시작점
-int main() {
+// 벤치마크처럼 이 파일을 포함해 코어만 쓰는 빌드는 MEMVIZ_NO_MAIN을 정의
+#ifndef MEMVIZ_NO_MAIN
+int main(int argc, char* argv[]) {
+#if MEMVIZ_PROFILING
+    ProfileReport profileReport;
+#endif
     MemoryManager memManager;
     Visualizer visualizer;
     ScriptParser parser(memManager);
 
+    bool batchMode = false;
+    vector<string> batchScripts;
+    vector<string> execCommand;
+    string preloadLibrary;
+    string attachPath;
+    string importPath;
+    vector<string> inspectQueries;
+    size_t eventRetention = 0;
+    string eventSpillPath;
+    bool allocatorChosen = false;
+    size_t jobs = thread::hardware_concurrency();
+    StepSettings settings;
+    AutoplaySettings& autoplay = settings.autoplay;
+
+    // --trace <파일>: 실행 중 발생한 이벤트를 바이너리 트레이스로 기록
+    // --batch <스크립트>...: 대화 없이 실행하고 요약만 출력
+    for (int i = 1; i < argc; i++) {
+        string arg = argv[i];
+        if (arg == "--trace" && i + 1 < argc) {
+            if (!memManager.startTrace(argv[++i])) {
+                cerr << "트레이스 파일을 열 수 없습니다: " << argv[i] << endl;
+                return 1;
+            }
+        }
+        else if (arg == "--batch") {
+            batchMode = true;
+        }
+        else if (arg == "--batch-list" && i + 1 < argc) {
+            batchMode = true;
+            if (!readScriptList(argv[++i], batchScripts)) {
+                cerr << "스크립트 목록을 읽을 수 없습니다: " << argv[i] << endl;
+                return 1;
+            }
+        }
+        else if (arg == "--jobs" && i + 1 < argc) {
+            jobs = strtoul(argv[++i], nullptr, 10);
+        }
+        else if (arg == "--autoplay") {
+            if (autoplay.fps == 0) autoplay.fps = 30;
+        }
+        else if (arg == "--fps" && i + 1 < argc) {
+            autoplay.fps = max(1, atoi(argv[++i]));
+        }
+        else if (arg == "--speed" && i + 1 < argc) {
+            if (autoplay.fps == 0) autoplay.fps = 30;
+            autoplay.stepsPerSecond = atof(argv[++i]);
+        }
+        else if (arg == "--checkpoint-interval" && i + 1 < argc) {
+            settings.timeTravel.checkpointInterval = strtoull(argv[++i], nullptr, 10);
+        }
+        else if (arg == "--max-checkpoints" && i + 1 < argc) {
+            settings.timeTravel.maxCheckpoints = strtoul(argv[++i], nullptr, 10);
+        }
+        else if (arg == "--profile" && i + 1 < argc) {
+#if MEMVIZ_PROFILING
+            profileReport.path = argv[++i];
+            Profiler::enable();
+#else
+            cerr << "프로파일러 없이 빌드되었습니다 (MEMVIZ_PROFILING=1로 다시 빌드)" << endl;
+            return 2;
+#endif
+        }
+        else if (arg == "--generate") {
+            // 나머지 인자는 모두 생성기 옵션
+            return runGenerate(vector<string>(argv + i + 1, argv + argc));
+        }
+        else if (arg == "--exec" && i + 1 < argc) {
+            // 나머지 인자는 모두 추적할 프로그램과 그 인자
+            execCommand.assign(argv + i + 1, argv + argc);
+            break;
+        }
+        else if (arg == "--preload-lib" && i + 1 < argc) {
+            preloadLibrary = argv[++i];
+        }
+        else if (arg == "--attach" && i + 1 < argc) {
+            attachPath = argv[++i];
+        }
+        else if (arg == "--import" && i + 1 < argc) {
+            importPath = argv[++i];
+        }
+        else if (arg == "--inspect" && i + 1 < argc) {
+            inspectQueries.push_back(argv[++i]);
+        }
+        else if (arg == "--event-retention" && i + 1 < argc) {
+            eventRetention = strtoull(argv[++i], nullptr, 10);
+        }
+        else if (arg == "--event-spill" && i + 1 < argc) {
+            eventSpillPath = argv[++i];
+        }
+        else if (arg == "--allocator" && i + 1 < argc) {
+            AllocatorKind kind;
+            if (!parseAllocatorKind(argv[++i], kind)) {
+                cerr << "알 수 없는 할당자: " << argv[i] << " (bump, slab, buddy, first-fit)" << endl;
+                return 2;
+            }
+            memManager.setAllocator(kind);
+            allocatorChosen = true;
+        }
+        else if (arg == "--help" || arg == "-h") {
+            printUsage(argv[0]);
+            return 0;
+        }
+        else if (batchMode) {
+            batchScripts.push_back(arg);
+        }
+        else {
+            printUsage(argv[0]);
+            return 2;
+        }
+    }
+
+    if (eventRetention > 0 || !eventSpillPath.empty()) {
+        memManager.setEventRetention(eventRetention > 0 ? eventRetention : memManager.getEvents().getCapacity(),
+            eventSpillPath);
+    }
+
+    if (!importPath.empty()) return runImport(importPath, memManager, allocatorChosen, inspectQueries);
+
+    if (!execCommand.empty() || !attachPath.empty()) {
+#ifndef _WIN32
+        if (!attachPath.empty()) return runPreloadAttach(attachPath, memManager);
+        return runPreloadExec(execCommand, preloadLibrary, memManager);
+#else
+        cerr << "실제 프로그램 추적은 Linux에서만 지원합니다" << endl;
+        return 1;
+#endif
+    }
+
+    if (batchMode) {
+        // 트레이스와 이벤트 기록 설정은 메인 관리자 하나에만 적용되므로 순차 실행
+        if (jobs <= 1 || memManager.isTracing() || !inspectQueries.empty() ||
+            eventRetention > 0 || !eventSpillPath.empty()) {
+            return runBatch(batchScripts, memManager, parser, inspectQueries);
+        }
+        return runParallelBatch(batchScripts, jobs, memManager.getAllocatorKind());
+    }
+
     cout << "\033[1;36m";
     cout << R"(
 ====================================
@@ -1057,12 +6809,14 @@ int main() {
     bool running = true;
 
     while (running) {
-        displayMenu();
+        displayMenu(memManager);
 
         int choice;
         cin >> choice;
 
         if (cin.fail()) {
+            // 입력이 끝났으면 (파이프 등) 메뉴를 반복하지 않고 종료
+            if (cin.eof()) break;
             cin.clear();
             cin.ignore(numeric_limits<streamsize>::max(), '\n');
             continue;
@@ -1075,13 +6829,24 @@ int main() {
             cin >> exampleChoice;
 
             if (exampleChoice > 0 && exampleChoice <= ScriptParser::getExampleCount()) {
-                runExampleStepByStep(exampleChoice - 1, memManager, parser, visualizer);
+                runExampleStepByStep(exampleChoice - 1, memManager, parser, visualizer, settings);
             }
             break;
         }
 
         case 2: {
-            runCustomCode(memManager, parser, visualizer);
+            runCustomCode(memManager, parser, visualizer, settings);
+            break;
+        }
+
+        case 3: {
+            bool reachability = memManager.getLeakMode() == LeakMode::REACHABILITY;
+            memManager.setLeakMode(reachability ? LeakMode::DIRECT_REFERENCE : LeakMode::REACHABILITY);
+            break;
+        }
+
+        case 4: {
+            runTraceReplay(visualizer);
             break;
         }
 
@@ -1102,3 +6867,4 @@ int main() {
 
     return 0;
 }
+#endif // MEMVIZ_NO_MAIN
@@ -0,0 +1,562 @@
+// C++ Memory Visualizer - 실제 프로그램의 할당 가로채기 라이브러리 (Linux, LD_PRELOAD)
+//
+// 빌드: g++ -std=c++17 -O2 -shared -fPIC -pthread -o libmemviz_preload.so memviz_preload.cpp -ldl
+// 사용: ./memviz --exec <프로그램> [인자...]   (라이브러리 경로는 --preload-lib 또는 MEMVIZ_PRELOAD)
+//
+// malloc/calloc/realloc/free/정렬 할당과 operator new/delete를 가로채 스레드별 링 버퍼에 기록하고,
+// 배출 스레드 하나가 링들을 모아 파이프(MEMVIZ_FD) 또는 FIFO(MEMVIZ_PATH)로 내보냄
+// 할당 경로에서는 잠금이나 시스템 호출 없이 전역 순번 하나와 자기 링에만 씀
+
+#include "memviz_preload.h"
+
+#include <algorithm>
+#include <atomic>
+#include <new>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+
+#include <dlfcn.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <linux/futex.h>
+#include <pthread.h>
+#include <sched.h>
+#include <signal.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+using namespace std;
+
+namespace {
+
+// ==================== 원래 함수 ====================
+
+using MallocFn = void* (*)(size_t);
+using CallocFn = void* (*)(size_t, size_t);
+using ReallocFn = void* (*)(void*, size_t);
+using FreeFn = void (*)(void*);
+using MemalignFn = void* (*)(size_t, size_t);
+using PosixMemalignFn = int (*)(void**, size_t, size_t);
+
+MallocFn realMalloc = nullptr;
+CallocFn realCalloc = nullptr;
+ReallocFn realRealloc = nullptr;
+FreeFn realFree = nullptr;
+MemalignFn realMemalign = nullptr;
+MemalignFn realAlignedAlloc = nullptr;
+PosixMemalignFn realPosixMemalign = nullptr;
+
+// dlsym이 내부에서 calloc/malloc을 부를 수 있으므로, 원래 함수를 찾는 동안은 정적 버퍼에서 나눠줌
+// 이 버퍼의 블록은 해제하지 않음 (free는 무시, realloc은 새 블록으로 복사)
+alignas(16) char bootstrapBuffer[64 * 1024];
+size_t bootstrapUsed = 0;
+bool resolving = false;
+
+bool isBootstrap(const void* ptr) {
+    const char* p = (const char*)ptr;
+    return p >= bootstrapBuffer && p < bootstrapBuffer + sizeof(bootstrapBuffer);
+}
+
+void* bootstrapAlloc(size_t size, size_t alignment = 16) {
+    // 정렬은 2의 거듭제곱만 받음 (정렬 할당 함수들의 규칙과 같음)
+    if (alignment < 16) alignment = 16;
+    if ((alignment & (alignment - 1)) != 0 || alignment > sizeof(bootstrapBuffer)) return nullptr;
+    uintptr_t base = (uintptr_t)bootstrapBuffer;
+    size_t offset = (size_t)(((base + bootstrapUsed + alignment - 1) & ~(uintptr_t)(alignment - 1)) - base);
+    if (offset > sizeof(bootstrapBuffer) || size > sizeof(bootstrapBuffer) - offset) return nullptr;
+    size = min((size + 15) & ~(size_t)15, sizeof(bootstrapBuffer) - offset);
+    bootstrapUsed = offset + size;
+    return bootstrapBuffer + offset;    // 정적 버퍼라 0으로 초기화되어 있음 (calloc에도 그대로 사용)
+}
+
+void resolveReal() {
+    if (realMalloc || resolving) return;
+    resolving = true;
+    realCalloc = (CallocFn)dlsym(RTLD_NEXT, "calloc");
+    realRealloc = (ReallocFn)dlsym(RTLD_NEXT, "realloc");
+    realFree = (FreeFn)dlsym(RTLD_NEXT, "free");
+    realMemalign = (MemalignFn)dlsym(RTLD_NEXT, "memalign");
+    realAlignedAlloc = (MemalignFn)dlsym(RTLD_NEXT, "aligned_alloc");
+    realPosixMemalign = (PosixMemalignFn)dlsym(RTLD_NEXT, "posix_memalign");
+    // realMalloc을 마지막에 채워서, 이것이 보이면 나머지도 준비된 것으로 취급
+    realMalloc = (MallocFn)dlsym(RTLD_NEXT, "malloc");
+    resolving = false;
+}
+
+// ==================== 스레드별 링 버퍼 ====================
+
+// 단일 생산자(소유 스레드) / 단일 소비자(배출 스레드) 링
+// head와 tail은 서로 다른 캐시 라인에 두고, 생산자는 head를 캐시해 가득 찼을 때만 다시 읽음
+// 링 크기는 L2 캐시에 들어가도록 작게 두고, 절반씩 찰 때마다 자고 있는 배출 스레드를 깨움
+constexpr size_t RING_CAPACITY = 4096;
+constexpr size_t RING_MASK = RING_CAPACITY - 1;
+constexpr size_t RING_KICK = RING_CAPACITY / 2;
+constexpr size_t MAX_RINGS = 1024;
+
+enum RingState : int {
+    RING_OWNED,
+    RING_RETIRED    // 소유 스레드 종료, 비워지면 다른 스레드가 재사용
+};
+
+struct Ring {
+    alignas(64) atomic<uint64_t> head;
+    alignas(64) atomic<uint64_t> tail;
+    uint64_t cachedHead;
+    atomic<int> state;
+    alignas(64) PreloadEvent slots[RING_CAPACITY];
+};
+
+atomic<Ring*> rings[MAX_RINGS];
+atomic<uint32_t> ringCount{ 0 };
+
+// 링을 더 만들 수 없거나 스레드 종료 중일 때 쓰는 공용 링 (생산자들은 스핀락으로 하나씩 씀)
+Ring* overflowRing = nullptr;
+atomic_flag overflowLock = ATOMIC_FLAG_INIT;
+
+// 프로세스 전체 이벤트 순번 (빈틈없이 증가, 소비자가 이 순서로 재정렬)
+alignas(64) atomic<uint64_t> nextSeq{ 0 };
+
+// 배출 스레드 깨우기: 잘 때만 futex로 깨우므로 평소 생산자는 플래그 하나만 읽음
+alignas(64) atomic<uint32_t> drainWake{ 0 };
+atomic<bool> drainSleeping{ false };
+
+atomic<bool> active{ false };
+atomic<bool> stopping{ false };
+int outFd = -1;
+pthread_t drainThread;
+bool drainStarted = false;
+pthread_key_t ringKey;
+
+// 라이브러리 내부 호출(배출 스레드, 링 생성 중의 할당)은 기록하지 않음
+// 정적 TLS로 두어 접근할 때 할당이 일어나지 않게 함
+__thread int hookDepth __attribute__((tls_model("initial-exec"))) = 0;
+__thread Ring* localRing __attribute__((tls_model("initial-exec"))) = nullptr;
+__thread bool threadExiting __attribute__((tls_model("initial-exec"))) = false;
+// 링을 더 만들 수 없었던 스레드: 할당마다 링 목록을 다시 훑지 않고 곧장 공용 링을 씀
+__thread bool ringUnavailable __attribute__((tls_model("initial-exec"))) = false;
+
+void wakeDrain() {
+    drainWake.fetch_add(1, memory_order_release);
+    syscall(SYS_futex, &drainWake, FUTEX_WAKE_PRIVATE, 1, nullptr, nullptr, 0);
+}
+
+Ring* mapRing() {
+    void* memory = mmap(nullptr, sizeof(Ring), PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (memory == MAP_FAILED) return nullptr;
+    Ring* ring = new (memory) Ring;
+    ring->head.store(0, memory_order_relaxed);
+    ring->tail.store(0, memory_order_relaxed);
+    ring->cachedHead = 0;
+    ring->state.store(RING_OWNED, memory_order_relaxed);
+    return ring;
+}
+
+// 스레드 종료: 링을 반납 (남은 이벤트는 배출 스레드가 계속 가져감)
+void retireRing(void* value) {
+    Ring* ring = (Ring*)value;
+    localRing = nullptr;
+    threadExiting = true;
+    ring->state.store(RING_RETIRED, memory_order_release);
+}
+
+// 현재 스레드의 링 확보: 비워진 반납 링을 먼저 재사용하고, 없으면 새로 매핑
+Ring* acquireRing() {
+    uint32_t count = ringCount.load(memory_order_acquire);
+    for (uint32_t i = 0; i < count; i++) {
+        Ring* ring = rings[i].load(memory_order_acquire);
+        if (!ring || ring->state.load(memory_order_acquire) != RING_RETIRED) continue;
+        uint64_t tail = ring->tail.load(memory_order_relaxed);
+        if (ring->head.load(memory_order_acquire) != tail) continue;
+        int expected = RING_RETIRED;
+        if (ring->state.compare_exchange_strong(expected, RING_OWNED, memory_order_acq_rel)) {
+            ring->cachedHead = tail;
+            pthread_setspecific(ringKey, ring);
+            return ring;
+        }
+    }
+
+    if (count >= MAX_RINGS) return nullptr;
+    Ring* ring = mapRing();
+    if (!ring) return nullptr;
+    uint32_t index = ringCount.fetch_add(1, memory_order_acq_rel);
+    if (index >= MAX_RINGS) {
+        ringCount.fetch_sub(1, memory_order_acq_rel);
+        munmap(ring, sizeof(Ring));
+        return nullptr;
+    }
+    rings[index].store(ring, memory_order_release);
+    pthread_setspecific(ringKey, ring);
+    return ring;
+}
+
+// 링에 한 건 추가, 가득 차면 배출될 때까지 양보하며 기다림 (종료 중이면 버림)
+bool pushEvent(Ring* ring, uint64_t seq, uint64_t address, uint64_t info) {
+    uint64_t tail = ring->tail.load(memory_order_relaxed);
+    if (tail - ring->cachedHead >= RING_CAPACITY) {
+        while (true) {
+            ring->cachedHead = ring->head.load(memory_order_acquire);
+            if (tail - ring->cachedHead < RING_CAPACITY) break;
+            if (stopping.load(memory_order_relaxed)) return false;
+            if (drainSleeping.load(memory_order_relaxed)) wakeDrain();
+            sched_yield();
+        }
+    }
+    PreloadEvent& slot = ring->slots[tail & RING_MASK];
+    slot.seq = seq;
+    slot.address = address;
+    slot.info = info;
+    ring->tail.store(tail + 1, memory_order_release);
+
+    if (((tail + 1) & (RING_KICK - 1)) == 0 && drainSleeping.load(memory_order_relaxed)) {
+        wakeDrain();
+    }
+    return true;
+}
+
+// 순번이 이미 정해진 이벤트를 현재 스레드의 링(없으면 공용 링)에 기록
+// 순번을 받은 이벤트는 반드시 기록해야 소비자의 재정렬이 빈 순번에서 멈추지 않음
+// (종료 중에 버린 이벤트는 스트림 끝에서 소비자가 건너뜀)
+void publish(PreloadOp op, uint64_t seq, const void* address, size_t size) {
+    uint64_t info = PreloadEvent::makeInfo(op, size);
+    Ring* ring = localRing;
+    if (!ring && !threadExiting && !ringUnavailable) {
+        hookDepth++;
+        ring = localRing = acquireRing();
+        hookDepth--;
+        ringUnavailable = !ring;
+    }
+    if (ring) {
+        pushEvent(ring, seq, (uint64_t)(uintptr_t)address, info);
+        return;
+    }
+    // 공용 링에도 못 넣은 레코드(종료 중)는 빈 순번으로 남고, 소비자가 missingEvents로 셈
+    while (overflowLock.test_and_set(memory_order_acquire)) sched_yield();
+    pushEvent(overflowRing, seq, (uint64_t)(uintptr_t)address, info);
+    overflowLock.clear(memory_order_release);
+}
+
+uint64_t takeSeq() {
+    return nextSeq.fetch_add(1, memory_order_relaxed);
+}
+
+bool shouldRecord() {
+    return hookDepth == 0 && active.load(memory_order_relaxed);
+}
+
+// ==================== 배출 스레드 ====================
+
+bool outFailed = false;
+
+void writeAll(const void* data, size_t bytes) {
+    const char* cursor = (const char*)data;
+    while (bytes > 0 && !outFailed) {
+        ssize_t written = write(outFd, cursor, bytes);
+        if (written < 0) {
+            if (errno == EINTR) continue;
+            // 소비자가 사라짐: 더 이상 기록하지 않고 링만 계속 비워 생산자가 막히지 않게 함
+            outFailed = true;
+            active.store(false, memory_order_relaxed);
+            return;
+        }
+        cursor += written;
+        bytes -= (size_t)written;
+    }
+}
+
+// 링 하나에 쌓인 이벤트를 링 메모리에서 바로 내보냄 (중간 버퍼 복사 없음), 내보낸 개수 반환
+size_t drainRing(Ring* ring) {
+    uint64_t head = ring->head.load(memory_order_relaxed);
+    uint64_t tail = ring->tail.load(memory_order_acquire);
+    size_t moved = (size_t)(tail - head);
+
+    while (head < tail) {
+        // 링 끝에서 끊기지 않는 연속 구간 단위로 기록
+        size_t first = (size_t)(head & RING_MASK);
+        size_t span = min<size_t>((size_t)(tail - head), RING_CAPACITY - first);
+        writeAll(&ring->slots[first], span * sizeof(PreloadEvent));
+        head += span;
+        ring->head.store(head, memory_order_release);
+    }
+    return moved;
+}
+
+size_t drainAll() {
+    size_t moved = 0;
+    uint32_t count = ringCount.load(memory_order_acquire);
+    for (uint32_t i = 0; i < count; i++) {
+        Ring* ring = rings[i].load(memory_order_acquire);
+        if (ring) moved += drainRing(ring);
+    }
+    moved += drainRing(overflowRing);
+    return moved;
+}
+
+void* drainMain(void*) {
+    hookDepth = 1;
+
+    PreloadStreamHeader header{};
+    memcpy(header.magic, PRELOAD_MAGIC, sizeof(header.magic));
+    header.version = PRELOAD_VERSION;
+    header.recordSize = sizeof(PreloadEvent);
+    header.pid = (uint32_t)getpid();
+    writeAll(&header, sizeof(header));
+
+    while (true) {
+        bool stop = stopping.load(memory_order_acquire);
+        if (drainAll() > 0) continue;
+        if (stop) break;
+
+        // 링이 절반 찰 때까지 잠 (할당이 뜸해도 지연이 길어지지 않도록 최대 2ms)
+        uint32_t seen = drainWake.load(memory_order_acquire);
+        drainSleeping.store(true, memory_order_seq_cst);
+        if (drainAll() == 0 && !stopping.load(memory_order_acquire)) {
+            timespec timeout{ 0, 2 * 1000 * 1000 };
+            syscall(SYS_futex, &drainWake, FUTEX_WAIT_PRIVATE, seen, &timeout, nullptr, 0);
+        }
+        drainSleeping.store(false, memory_order_relaxed);
+    }
+    return nullptr;
+}
+
+// fork된 자식은 배출 스레드가 없으므로 기록하지 않음
+void afterForkChild() {
+    active.store(false, memory_order_relaxed);
+    drainStarted = false;
+    outFd = -1;
+}
+
+__attribute__((constructor)) void startTracing() {
+    resolveReal();
+
+    int fd = -1;
+    if (const char* fdText = getenv(PRELOAD_FD_ENV)) {
+        fd = atoi(fdText);
+    }
+    else if (const char* path = getenv(PRELOAD_PATH_ENV)) {
+        // FIFO면 그대로 열리고, 일반 파일이면 새로 만들어 나중에 --import로 읽을 수 있게 함
+        fd = open(path, O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    }
+    // 이 프로세스가 실행하는 다른 프로그램이 같은 스트림에 쓰지 않도록 환경에서 지우고 상속도 막음
+    unsetenv(PRELOAD_FD_ENV);
+    unsetenv(PRELOAD_PATH_ENV);
+    if (fd < 0) return;
+    fcntl(fd, F_SETFD, FD_CLOEXEC);
+
+    overflowRing = mapRing();
+    if (!overflowRing || pthread_key_create(&ringKey, retireRing) != 0) return;
+    outFd = fd;
+    pthread_atfork(nullptr, nullptr, afterForkChild);
+
+    // 배출 스레드는 모든 시그널을 막은 채 시작 (대상 프로그램의 핸들러가 이 스레드에서 돌지 않고,
+    // 소비자가 먼저 끝나도 SIGPIPE 대신 write 오류로 받음)
+    sigset_t all, previous;
+    sigfillset(&all);
+    pthread_sigmask(SIG_SETMASK, &all, &previous);
+    hookDepth++;
+    drainStarted = pthread_create(&drainThread, nullptr, drainMain, nullptr) == 0;
+    hookDepth--;
+    pthread_sigmask(SIG_SETMASK, &previous, nullptr);
+
+    if (drainStarted) active.store(true, memory_order_release);
+}
+
+// 라이브러리가 가장 먼저 적재되므로 소멸자는 대상 프로그램의 정리 작업이 끝난 뒤에 실행됨
+__attribute__((destructor)) void stopTracing() {
+    if (!drainStarted) return;
+    active.store(false, memory_order_relaxed);
+    stopping.store(true, memory_order_release);
+    wakeDrain();
+    pthread_join(drainThread, nullptr);
+    drainStarted = false;
+    close(outFd);
+    outFd = -1;
+}
+
+// ==================== 할당 경로 ====================
+
+void* tracedMalloc(size_t size, PreloadOp op) {
+    if (!realMalloc) {
+        resolveReal();
+        if (!realMalloc) return bootstrapAlloc(size);
+    }
+    if (!shouldRecord()) return realMalloc(size);
+    void* p = realMalloc(size);
+    // 할당은 반환 뒤에 순번을 받음: 같은 주소를 먼저 해제한 쪽보다 항상 뒤에 정렬됨
+    if (p) publish(op, takeSeq(), p, size);
+    return p;
+}
+
+void tracedFree(void* ptr, PreloadOp op) {
+    if (!ptr || isBootstrap(ptr)) return;
+    if (!realFree) resolveReal();
+    if (!shouldRecord()) {
+        realFree(ptr);
+        return;
+    }
+    // 해제는 실제 해제 전에 순번을 받음: 이 주소를 다시 받아 갈 할당보다 항상 앞에 정렬됨
+    uint64_t seq = takeSeq();
+    realFree(ptr);
+    publish(op, seq, ptr, 0);
+}
+
+void* tracedNew(size_t size, PreloadOp op) {
+    if (size == 0) size = 1;
+    while (true) {
+        void* p = tracedMalloc(size, op);
+        if (p) return p;
+        new_handler handler = get_new_handler();
+        if (!handler) throw bad_alloc();
+        handler();
+    }
+}
+
+} // namespace
+
+// ==================== 가로채는 함수 ====================
+
+extern "C" {
+
+void* malloc(size_t size) {
+    return tracedMalloc(size, PreloadOp::MALLOC);
+}
+
+void free(void* ptr) {
+    tracedFree(ptr, PreloadOp::FREE);
+}
+
+void* calloc(size_t count, size_t size) {
+    if (!realCalloc) {
+        resolveReal();
+        if (!realCalloc) {
+            if (size != 0 && count > (size_t)-1 / size) return nullptr;
+            return bootstrapAlloc(count * size);
+        }
+    }
+    if (!shouldRecord()) return realCalloc(count, size);
+    void* p = realCalloc(count, size);
+    if (p) publish(PreloadOp::CALLOC, takeSeq(), p, count * size);
+    return p;
+}
+
+void* realloc(void* ptr, size_t size) {
+    if (isBootstrap(ptr)) {
+        // 정적 버퍼의 블록은 크기를 모르므로 남은 범위 안에서 복사
+        void* p = malloc(size);
+        if (p) {
+            size_t available = bootstrapBuffer + sizeof(bootstrapBuffer) - (char*)ptr;
+            memcpy(p, ptr, min(size, available));
+        }
+        return p;
+    }
+    if (!realRealloc) {
+        resolveReal();
+        if (!realRealloc) return bootstrapAlloc(size);
+    }
+    if (!shouldRecord()) return realRealloc(ptr, size);
+
+    // 해제 쪽 순번은 호출 전에, 할당 쪽 순번은 반환 뒤에 받아 다른 스레드와의 주소 재사용 순서를 지킴
+    // 실패하면 원래 블록이 그대로이므로 해제 쪽 레코드는 주소 없이 채워 빈 순번만 메움
+    uint64_t freeSeq = ptr ? takeSeq() : 0;
+    void* p = realRealloc(ptr, size);
+    bool freed = ptr && (p || size == 0);
+    if (ptr) publish(PreloadOp::REALLOC_FREE, freeSeq, freed ? ptr : nullptr, 0);
+    if (p) publish(PreloadOp::REALLOC, takeSeq(), p, size);
+    return p;
+}
+
+int posix_memalign(void** out, size_t alignment, size_t size) {
+    if (!realPosixMemalign) {
+        resolveReal();
+        if (!realPosixMemalign) {
+            if (alignment % sizeof(void*) != 0 || (alignment & (alignment - 1)) != 0) return EINVAL;
+            void* p = bootstrapAlloc(size, alignment);
+            if (!p) return ENOMEM;
+            *out = p;
+            return 0;
+        }
+    }
+    if (!shouldRecord()) return realPosixMemalign(out, alignment, size);
+    int result = realPosixMemalign(out, alignment, size);
+    if (result == 0) publish(PreloadOp::ALIGNED, takeSeq(), *out, size);
+    return result;
+}
+
+void* aligned_alloc(size_t alignment, size_t size) {
+    if (!realAlignedAlloc) {
+        resolveReal();
+        if (!realAlignedAlloc) return bootstrapAlloc(size, alignment);
+    }
+    if (!shouldRecord()) return realAlignedAlloc(alignment, size);
+    void* p = realAlignedAlloc(alignment, size);
+    if (p) publish(PreloadOp::ALIGNED, takeSeq(), p, size);
+    return p;
+}
+
+void* memalign(size_t alignment, size_t size) {
+    if (!realMemalign) {
+        resolveReal();
+        if (!realMemalign) return bootstrapAlloc(size, alignment);
+    }
+    if (!shouldRecord()) return realMemalign(alignment, size);
+    void* p = realMemalign(alignment, size);
+    if (p) publish(PreloadOp::ALIGNED, takeSeq(), p, size);
+    return p;
+}
+
+} // extern "C"
+
+// operator new/delete는 libstdc++ 구현을 거치지 않고 직접 기록해 종류(new/new[])를 구분함
+// 정렬 지정 버전은 libstdc++가 aligned_alloc/free로 구현하므로 위의 가로채기로 기록됨
+
+void* operator new(size_t size) {
+    return tracedNew(size, PreloadOp::NEW);
+}
+
+void* operator new[](size_t size) {
+    return tracedNew(size, PreloadOp::NEW_ARRAY);
+}
+
+void* operator new(size_t size, const nothrow_t&) noexcept {
+    try {
+        return tracedNew(size, PreloadOp::NEW);
+    }
+    catch (...) {
+        return nullptr;
+    }
+}
+
+void* operator new[](size_t size, const nothrow_t&) noexcept {
+    try {
+        return tracedNew(size, PreloadOp::NEW_ARRAY);
+    }
+    catch (...) {
+        return nullptr;
+    }
+}
+
+void operator delete(void* ptr) noexcept {
+    tracedFree(ptr, PreloadOp::DELETE);
+}
+
+void operator delete[](void* ptr) noexcept {
+    tracedFree(ptr, PreloadOp::DELETE_ARRAY);
+}
+
+void operator delete(void* ptr, size_t) noexcept {
+    tracedFree(ptr, PreloadOp::DELETE);
+}
+
+void operator delete[](void* ptr, size_t) noexcept {
+    tracedFree(ptr, PreloadOp::DELETE_ARRAY);
+}
+
+void operator delete(void* ptr, const nothrow_t&) noexcept {
+    tracedFree(ptr, PreloadOp::DELETE);
+}
+
+void operator delete[](void* ptr, const nothrow_t&) noexcept {
+    tracedFree(ptr, PreloadOp::DELETE_ARRAY);
+}
@@ -0,0 +1,60 @@
+// C++ Memory Visualizer - 할당 가로채기 라이브러리와 소비자가 공유하는 스트림 형식
+//
+// 스트림 구조: PreloadStreamHeader 한 번 + PreloadEvent 고정 길이 레코드 반복 (리틀 엔디언)
+// seq는 프로세스 전체에서 0부터 빈틈없이 증가하므로, 스레드별 링에서 섞여 도착한
+// 레코드를 소비자가 seq 순서로 다시 정렬할 수 있음
+
+#pragma once
+
+#include <cstdint>
+
+// 가로챈 호출 종류
+enum class PreloadOp : uint8_t {
+    MALLOC,
+    CALLOC,
+    REALLOC,        // realloc의 할당 쪽 (해제 쪽은 REALLOC_FREE로 순번을 따로 받음)
+    ALIGNED,        // posix_memalign / aligned_alloc / memalign
+    NEW,
+    NEW_ARRAY,
+    FREE,
+    REALLOC_FREE,   // 주소가 0이면 realloc 실패로 아무것도 해제되지 않음
+    DELETE,
+    DELETE_ARRAY
+};
+
+inline bool isReleaseOp(PreloadOp op) {
+    return op >= PreloadOp::FREE;
+}
+
+struct PreloadStreamHeader {
+    char magic[4];          // "MVPL"
+    uint32_t version;
+    uint32_t recordSize;    // sizeof(PreloadEvent)
+    uint32_t pid;
+};
+
+// 할당이면 새 주소와 크기, 해제면 해제된 주소 (크기 0)
+// 링에 쓰는 양을 줄이려고 종류는 크기의 상위 8비트에 함께 담음
+struct PreloadEvent {
+    uint64_t seq;
+    uint64_t address;
+    uint64_t info;
+
+    static constexpr int OP_SHIFT = 56;
+    static constexpr uint64_t SIZE_MASK = (1ULL << OP_SHIFT) - 1;
+
+    static uint64_t makeInfo(PreloadOp op, uint64_t size) {
+        return ((uint64_t)op << OP_SHIFT) | (size & SIZE_MASK);
+    }
+    PreloadOp op() const { return (PreloadOp)(info >> OP_SHIFT); }
+    uint64_t size() const { return info & SIZE_MASK; }
+};
+
+static_assert(sizeof(PreloadEvent) == 24, "PreloadEvent layout");
+
+constexpr char PRELOAD_MAGIC[4] = { 'M', 'V', 'P', 'L' };
+constexpr uint32_t PRELOAD_VERSION = 1;
+
+// 추적 대상 프로그램이 이벤트를 쓸 파일 디스크립터 / 경로(FIFO 등)를 전달하는 환경 변수
+constexpr const char* PRELOAD_FD_ENV = "MEMVIZ_FD";
+constexpr const char* PRELOAD_PATH_ENV = "MEMVIZ_PATH";